@@ -2,65 +2,186 @@
 #define ARRAY_LIST_H
 
 #include <cstddef>
+#include <cstring>
 #include <iostream>
-#include <stdexcept> 
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
 #include <utility>
 
+template <typename Object, class Allocator = std::allocator<Object>>
+class ArrayList;
+
+// Storage a plain ArrayList starts out with: none, nothing is allocated until the first element.
 template <typename Object>
-class ArrayList {
-    size_t _size; // size
-    size_t _capacity;
-	Object* array; // dynamic array of objects
+struct NoInlineBuffer {
+    static constexpr size_t capacity = 0;
+
+    Object* data()
+    {
+        return nullptr;
+    }
+    const Object* data() const
+    {
+        return nullptr;
+    }
+};
+
+// Element storage shared by ArrayList and SmallArrayList. Buffer is what a list starts
+// out with before it needs the allocator, and what it falls back to once it fits again.
+template <typename Object, class Allocator, class Buffer>
+class ArrayListBase : private Buffer {
+    protected:
+        using AllocTraits = std::allocator_traits<Allocator>;
+
+        Allocator alloc;
+        size_t _size; // size
+        size_t _capacity;
+        Object* array; // raw storage, only [0, _size) holds constructed objects
 
     public:
-        ArrayList<Object>() : _size(0), _capacity(1), array(new Object[1]) {}
-        explicit ArrayList<Object>(size_t s) : _size(0), _capacity(s), array(new Object[s]) {}
+        using allocator_type = Allocator;
 
-        ArrayList(const ArrayList& other) : _size(other._size), _capacity(other._capacity), array(new Object[other._capacity]) 
+        ArrayListBase(const ArrayListBase& other) = delete;
+        ArrayListBase& operator=(const ArrayListBase& other) = delete;
+
+        Allocator get_allocator() const
         {
-            for (size_t i = 0; i < _size; i++)
+            return alloc;
+        }
+
+        size_t size() const
+        {
+            return _size;
+        }
+
+        size_t capacity() const
+        {
+            return _capacity;
+        }
+
+        bool empty() const
+        {
+            return _size == 0;
+        }
+
+        Object& operator[](size_t index)
+        {
+            if (index >= _size)
             {
-                array[i] = other.array[i];
+                throw std::out_of_range("");
             }
+            return array[index];
         }
 
-        ArrayList& operator=(const ArrayList& other)
+        const Object& operator[](size_t index) const
         {
-            if (this == &other)
+            if (index >= _size)
             {
-                return *this;
+                throw std::out_of_range("");
             }
-            _size = other._size;
-            _capacity = other._capacity;
-            delete[] array;
-            array = new Object[_capacity];
-            for (size_t i = 0; i < _size; i++)
+            return array[index];
+        }
+
+        Object* data()
+        {
+            return array;
+        }
+
+        const Object* data() const
+        {
+            return array;
+        }
+
+        Object* begin()
+        {
+            return array;
+        }
+
+        const Object* begin() const
+        {
+            return array;
+        }
+
+        Object* end()
+        {
+            return array + _size;
+        }
+
+        const Object* end() const
+        {
+            return array + _size;
+        }
+
+        void reserve(size_t newCapacity)
+        {
+            if (newCapacity > _capacity)
             {
-                array[i] = other.array[i];
+                reallocate(newCapacity);
             }
-            
-            return *this;
         }
 
-        ~ArrayList()
+        void shrink_to_fit()
         {
+            if (array != inlineData() && _size < _capacity)
+            {
+                reallocate(_size);
+            }
+        }
+
+        void clear()
+        {
+            destroy(array, _size);
             _size = 0;
-            _capacity = 0;
-            delete[] array;
         }
 
-        size_t size()
+        void push_back(const Object& other)
         {
-            return _size;
+            emplace_back(other);
         }
 
-        Object& operator[](size_t index)
+        void push_back(Object&& other)
         {
-            if (index >= _size)
+            emplace_back(std::move(other));
+        }
+
+        template <class... Args>
+        Object& emplace_back(Args&&... args)
+        {
+            if (_size < _capacity)
             {
-                throw std::out_of_range("");
+                AllocTraits::construct(alloc, array + _size, std::forward<Args>(args)...);
+                _size++;
+                return array[_size - 1];
             }
-            return array[index];
+            // build the new element before the old buffer goes away, args may refer into it
+            size_t newCapacity = growthCapacity(_size + 1);
+            Object* newArray = allocate(newCapacity);
+            try
+            {
+                AllocTraits::construct(alloc, newArray + _size, std::forward<Args>(args)...);
+            }
+            catch (...)
+            {
+                deallocate(newArray, newCapacity);
+                throw;
+            }
+            try
+            {
+                transfer(newArray, array, _size);
+            }
+            catch (...)
+            {
+                AllocTraits::destroy(alloc, newArray + _size);
+                deallocate(newArray, newCapacity);
+                throw;
+            }
+            adopt(newArray, newCapacity);
+            _size++;
+            return array[_size - 1];
         }
 
         void insert(size_t index, const Object& other)
@@ -68,37 +189,123 @@ class ArrayList {
             if (index > _size) {
                 throw std::out_of_range("");
             }
-            if (_size == _capacity)
+            if (index == _size)
+            {
+                emplace_back(other);
+                return;
+            }
+            Object temp(other); // other may live in the part of the array we are about to shift
+            openGap(index, 1);
+            AllocTraits::construct(alloc, array + index, std::move(temp));
+            _size++;
+        }
+
+        void insert(size_t index, Object&& other)
+        {
+            if (index > _size) {
+                throw std::out_of_range("");
+            }
+            if (index == _size)
             {
-                if (_capacity == 0)
+                emplace_back(std::move(other));
+                return;
+            }
+            Object temp(std::move(other));
+            openGap(index, 1);
+            AllocTraits::construct(alloc, array + index, std::move(temp));
+            _size++;
+        }
+
+        // Inserts [first, last) before index with a single shift of the tail.
+        // The range must not come from this list.
+        template <class InputIt, class = std::enable_if_t<std::is_base_of_v<std::input_iterator_tag,
+                  typename std::iterator_traits<InputIt>::iterator_category>>>
+        void insert(size_t index, InputIt first, InputIt last)
+        {
+            if (index > _size) {
+                throw std::out_of_range("");
+            }
+            using Category = typename std::iterator_traits<InputIt>::iterator_category;
+            if constexpr (!std::is_base_of_v<std::forward_iterator_tag, Category>)
+            {
+                // single pass range, count it by buffering first
+                ArrayList<Object, Allocator> buffered(alloc);
+                for (; first != last; ++first)
                 {
-                    _capacity = 1;
+                    buffered.emplace_back(*first);
                 }
-                _capacity *= 2;
-                Object* tempList = new Object[_capacity];
-                for (size_t i = 0; i < index; i++)
+                insert(index, std::make_move_iterator(buffered.begin()), std::make_move_iterator(buffered.end()));
+            }
+            else
+            {
+                size_t count = std::distance(first, last);
+                if (count == 0)
                 {
-                    tempList[i] = array[i];
+                    return;
                 }
-                for (size_t i = index + 1; i < _size + 1; i++)
+                openGap(index, count);
+                size_t built = 0;
+                try
                 {
-                    tempList[i] = array[i-1];
+                    for (; first != last; ++first, ++built)
+                    {
+                        AllocTraits::construct(alloc, array + index + built, *first);
+                    }
                 }
-                tempList[index] = other;
-                delete[] array;
-                array = tempList;
-                _size++;
+                catch (...)
+                {
+                    closeGap(index, count, built);
+                    throw;
+                }
+                _size += count;
+            }
+        }
+
+        void insert(size_t index, size_t count, const Object& value)
+        {
+            if (index > _size) {
+                throw std::out_of_range("");
+            }
+            if (count == 0)
+            {
                 return;
             }
-            for (size_t i = _size; i > index; i--)
+            Object temp(value);
+            openGap(index, count);
+            size_t built = 0;
+            try
             {
-                array[i] = array[i-1];
+                for (; built < count; built++)
+                {
+                    AllocTraits::construct(alloc, array + index + built, temp);
+                }
             }
-            array[index] = other;
-            _size++;
+            catch (...)
+            {
+                closeGap(index, count, built);
+                throw;
+            }
+            _size += count;
         }
 
-        void remove(size_t index) 
+        void append(const Object* values, size_t count)
+        {
+            insert(_size, values, values + count);
+        }
+
+        void append(const ArrayListBase& other)
+        {
+            if (this == &other)
+            {
+                ArrayList<Object, Allocator> copy(alloc);
+                copy.append(other.array, other._size);
+                append(copy.data(), copy.size());
+                return;
+            }
+            append(other.array, other._size);
+        }
+
+        void remove(size_t index)
         {
             if (_size == 0 || array == nullptr || _capacity == 0)
             {
@@ -108,11 +315,25 @@ class ArrayList {
             {
                 throw std::out_of_range("");
             }
-            for (size_t i = index; i < _size - 1; i++)
+            AllocTraits::destroy(alloc, array + index);
+            relocate(array + index, array + index + 1, _size - index - 1);
+            _size--;
+        }
+
+        // Removes the elements with indices in [first, last), shifting the tail once.
+        void erase(size_t first, size_t last)
+        {
+            if (first > last || last > _size)
             {
-                array[i] = array[i+1];
+                throw std::out_of_range("");
             }
-            _size--;
+            if (first == last)
+            {
+                return;
+            }
+            destroy(array + first, last - first);
+            relocate(array + first, array + last, _size - last);
+            _size -= last - first;
         }
 
         void printList() {
@@ -122,6 +343,311 @@ class ArrayList {
             }
             std::cout << std::endl;
         }
+
+    protected:
+        explicit ArrayListBase(const Allocator& allocator)
+            : Buffer(), alloc(allocator), _size(0), _capacity(Buffer::capacity), array(inlineData()) {}
+
+        ~ArrayListBase()
+        {
+            clear();
+            deallocate(array, _capacity);
+            _capacity = 0;
+        }
+
+        Object* inlineData()
+        {
+            return Buffer::data();
+        }
+
+        const Object* inlineData() const
+        {
+            return Buffer::data();
+        }
+
+        void copyAssign(const ArrayListBase& other)
+        {
+            clear();
+            if constexpr (AllocTraits::propagate_on_container_copy_assignment::value)
+            {
+                if (alloc != other.alloc)
+                {
+                    deallocate(array, _capacity);
+                    array = inlineData();
+                    _capacity = Buffer::capacity;
+                }
+                alloc = other.alloc;
+            }
+            copyFrom(other);
+        }
+
+        void moveAssign(ArrayListBase& other)
+        {
+            clear();
+            if (!AllocTraits::propagate_on_container_move_assignment::value && alloc != other.alloc)
+            {
+                // can't adopt memory from a different resource, move the elements over instead
+                reserve(other._size);
+                for (size_t i = 0; i < other._size; i++)
+                {
+                    AllocTraits::construct(alloc, array + i, std::move(other.array[i]));
+                    _size++;
+                }
+                other.clear();
+                return;
+            }
+            deallocate(array, _capacity);
+            array = inlineData();
+            _capacity = Buffer::capacity;
+            if constexpr (AllocTraits::propagate_on_container_move_assignment::value)
+            {
+                alloc = std::move(other.alloc);
+            }
+            takeFrom(other);
+        }
+
+        void copyFrom(const ArrayListBase& other)
+        {
+            reserve(other._size);
+            for (size_t i = 0; i < other._size; i++)
+            {
+                AllocTraits::construct(alloc, array + i, other.array[i]);
+                _size++;
+            }
+        }
+
+        // Steals an allocated buffer outright, elements in other's own buffer have to be
+        // moved one by one. Expects this list to be empty and on its own buffer.
+        void takeFrom(ArrayListBase& other)
+        {
+            if (other.array == other.inlineData())
+            {
+                transfer(array, other.array, other._size);
+                _size = other._size;
+                other.clear();
+                return;
+            }
+            _size = other._size;
+            _capacity = other._capacity;
+            array = other.array;
+            other._size = 0;
+            other._capacity = Buffer::capacity;
+            other.array = other.inlineData();
+        }
+
+    private:
+        Object* allocate(size_t n)
+        {
+            if (n == 0)
+            {
+                return nullptr;
+            }
+            return AllocTraits::allocate(alloc, n);
+        }
+
+        void deallocate(Object* p, size_t n)
+        {
+            if (p != nullptr && p != inlineData())
+            {
+                AllocTraits::deallocate(alloc, p, n);
+            }
+        }
+
+        void destroy(Object* p, size_t n)
+        {
+            for (size_t i = 0; i < n; i++)
+            {
+                AllocTraits::destroy(alloc, p + i);
+            }
+        }
+
+        // Builds n objects at dest from the n at src, moving them when that can't throw.
+        // If it throws, nothing is left built at dest and src still holds every element.
+        void transfer(Object* dest, Object* src, size_t n)
+        {
+            if constexpr (std::is_trivially_copyable_v<Object>)
+            {
+                if (n > 0)
+                {
+                    std::memcpy(static_cast<void*>(dest), static_cast<const void*>(src), n * sizeof(Object));
+                }
+            }
+            else
+            {
+                size_t built = 0;
+                try
+                {
+                    for (; built < n; built++)
+                    {
+                        AllocTraits::construct(alloc, dest + built, std::move_if_noexcept(src[built]));
+                    }
+                }
+                catch (...)
+                {
+                    destroy(dest, built);
+                    throw;
+                }
+            }
+        }
+
+        // Switches to newArray once transfer has filled it, ending the old elements.
+        void adopt(Object* newArray, size_t newCapacity)
+        {
+            destroy(array, _size);
+            deallocate(array, _capacity);
+            array = newArray;
+            _capacity = newCapacity;
+        }
+
+        // Shifts n objects from src to dest inside the array and ends the lifetime of the
+        // sources. The ranges may overlap.
+        void relocate(Object* dest, Object* src, size_t n)
+        {
+            if (n == 0 || dest == src)
+            {
+                return;
+            }
+            if constexpr (std::is_trivially_copyable_v<Object>)
+            {
+                std::memmove(static_cast<void*>(dest), static_cast<const void*>(src), n * sizeof(Object));
+            }
+            else if (dest < src)
+            {
+                for (size_t i = 0; i < n; i++)
+                {
+                    AllocTraits::construct(alloc, dest + i, std::move_if_noexcept(src[i]));
+                    AllocTraits::destroy(alloc, src + i);
+                }
+            }
+            else
+            {
+                for (size_t i = n; i > 0; i--)
+                {
+                    AllocTraits::construct(alloc, dest + i - 1, std::move_if_noexcept(src[i - 1]));
+                    AllocTraits::destroy(alloc, src + i - 1);
+                }
+            }
+        }
+
+        size_t growthCapacity(size_t minCapacity) const
+        {
+            size_t newCapacity = _capacity == 0 ? 1 : _capacity * 2;
+            return newCapacity < minCapacity ? minCapacity : newCapacity;
+        }
+
+        // Falls back to the list's own buffer when the new capacity fits in it.
+        void reallocate(size_t newCapacity)
+        {
+            if constexpr (Buffer::capacity > 0)
+            {
+                if (newCapacity <= Buffer::capacity)
+                {
+                    if (array == inlineData())
+                    {
+                        return;
+                    }
+                    transfer(inlineData(), array, _size);
+                    adopt(inlineData(), Buffer::capacity);
+                    return;
+                }
+            }
+            Object* newArray = allocate(newCapacity);
+            try
+            {
+                transfer(newArray, array, _size);
+            }
+            catch (...)
+            {
+                deallocate(newArray, newCapacity);
+                throw;
+            }
+            adopt(newArray, newCapacity);
+        }
+
+        // Leaves [index, index + count) unconstructed with the old tail moved past it.
+        // Grows the storage when needed; _size is left for the caller to bump.
+        void openGap(size_t index, size_t count)
+        {
+            if (_size + count <= _capacity)
+            {
+                relocate(array + index + count, array + index, _size - index);
+                return;
+            }
+            size_t newCapacity = growthCapacity(_size + count);
+            Object* newArray = allocate(newCapacity);
+            try
+            {
+                transfer(newArray, array, index);
+                try
+                {
+                    transfer(newArray + index + count, array + index, _size - index);
+                }
+                catch (...)
+                {
+                    destroy(newArray, index);
+                    throw;
+                }
+            }
+            catch (...)
+            {
+                deallocate(newArray, newCapacity);
+                throw;
+            }
+            adopt(newArray, newCapacity);
+        }
+
+        // Undoes openGap when filling it failed after built elements.
+        void closeGap(size_t index, size_t count, size_t built)
+        {
+            destroy(array + index, built);
+            relocate(array + index, array + index + count, _size - index);
+        }
 };
 
-#endif  // ARRAY_LIST_H
\ No newline at end of file
+template <typename Object, class Allocator>
+class ArrayList : public ArrayListBase<Object, Allocator, NoInlineBuffer<Object>> {
+    using Base = ArrayListBase<Object, Allocator, NoInlineBuffer<Object>>;
+    using AllocTraits = std::allocator_traits<Allocator>;
+
+    public:
+        ArrayList() : Base(Allocator()) {}
+        explicit ArrayList(const Allocator& allocator) : Base(allocator) {}
+        explicit ArrayList(size_t s, const Allocator& allocator = Allocator()) : Base(allocator)
+        {
+            this->reserve(s);
+        }
+
+        ArrayList(const ArrayList& other) : Base(AllocTraits::select_on_container_copy_construction(other.alloc))
+        {
+            this->copyFrom(other);
+        }
+
+        ArrayList(ArrayList&& other) noexcept : Base(std::move(other.alloc))
+        {
+            this->takeFrom(other); // nothing to move one by one without a buffer of our own
+        }
+
+        ArrayList& operator=(const ArrayList& other)
+        {
+            if (this != &other)
+            {
+                this->copyAssign(other);
+            }
+            return *this;
+        }
+
+        ArrayList& operator=(ArrayList&& other) noexcept(AllocTraits::propagate_on_container_move_assignment::value
+                                                         || AllocTraits::is_always_equal::value)
+        {
+            if (this != &other)
+            {
+                this->moveAssign(other);
+            }
+            return *this;
+        }
+};
+
+template <typename Object>
+using PmrArrayList = ArrayList<Object, std::pmr::polymorphic_allocator<Object>>;
+
+#endif  // ARRAY_LIST_H
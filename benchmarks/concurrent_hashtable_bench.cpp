@@ -0,0 +1,102 @@
+// Mixed read/write throughput of ConcurrentHashTable against the separate chaining
+// HashTable behind one mutex, from 1 up to 48 threads, with 90% and 50% lookups; the
+// rest is split between inserts and removals over a key range that stays half full.
+// Usage: concurrent_hashtable_bench [operations per thread] [key range]
+#include "../concurrent_hashtable.h"
+#include "../hashtable_separate_chaining.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+// Starts threads copies of work together, returns millions of operations per second.
+template <class Work>
+static double throughput(size_t threads, size_t operations, Work work)
+{
+    std::atomic<bool> go(false);
+    std::vector<std::thread> pool;
+    for (size_t t = 0; t < threads; t++)
+    {
+        pool.emplace_back([&, t] {
+            while (!go.load(std::memory_order_acquire))
+            {
+                std::this_thread::yield();
+            }
+            work(t);
+        });
+    }
+    auto start = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    for (std::thread& thread : pool)
+    {
+        thread.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return threads * operations / elapsed.count() / 1e6;
+}
+
+// Runs operations random keys through the three calls, readPercent of them lookups.
+template <class Contains, class Insert, class Remove>
+static void mix(size_t t, size_t operations, unsigned keys, unsigned readPercent,
+                Contains contains, Insert insert, Remove remove)
+{
+    std::minstd_rand rng((unsigned) t + 1);
+    for (size_t i = 0; i < operations; i++)
+    {
+        unsigned key = (unsigned) rng() % keys;
+        unsigned roll = (unsigned) rng() % 100;
+        if (roll < readPercent)
+        {
+            contains(key);
+        }
+        else if (roll % 2 == 0)
+        {
+            insert(key);
+        }
+        else
+        {
+            remove(key);
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    size_t operations = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200000;
+    unsigned keys = argc > 2 ? (unsigned) std::strtoul(argv[2], nullptr, 10) : 1u << 16;
+    const size_t threadCounts[] = {1, 2, 4, 8, 16, 32, 48};
+    for (unsigned readPercent : {90u, 50u})
+    {
+        std::printf("%u%% lookups\n%8s %26s %26s\n", readPercent, "threads", "ConcurrentHashTable Mop/s", "HashTable + mutex Mop/s");
+        for (size_t threads : threadCounts)
+        {
+            ConcurrentHashTable<unsigned> concurrent;
+            HashTable<unsigned> locked;
+            std::mutex lock;
+            for (unsigned key = 0; key < keys; key += 2)
+            {
+                concurrent.insert(key);
+                locked.insert(key);
+            }
+            double striped = throughput(threads, operations, [&](size_t t) {
+                mix(t, operations, keys, readPercent,
+                    [&](unsigned key) { return concurrent.contains(key); },
+                    [&](unsigned key) { return concurrent.insert(key); },
+                    [&](unsigned key) { return concurrent.remove(key); });
+            });
+            double mutex = throughput(threads, operations, [&](size_t t) {
+                mix(t, operations, keys, readPercent,
+                    [&](unsigned key) { std::lock_guard<std::mutex> guard(lock); return locked.contains(key); },
+                    [&](unsigned key) { std::lock_guard<std::mutex> guard(lock); return locked.insert(key); },
+                    [&](unsigned key) { std::lock_guard<std::mutex> guard(lock); return locked.remove(key); });
+            });
+            std::printf("%8zu %26.2f %26.2f\n", threads, striped, mutex);
+        }
+        std::printf("\n");
+    }
+    return 0;
+}
@@ -0,0 +1,126 @@
+// Throughput of ConcurrentPriorityQueue against a mutex guarded PriorityQueue, with
+// threads that push and pop in turn, and the rank error the relaxation costs: how many
+// smaller elements were still queued when try_pop returned one.
+// Usage: concurrent_priority_queue_bench [operations per thread] [elements for rank error]
+#include "../concurrent_priority_queue.h"
+#include "../priority_queue.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+// Starts threads copies of work together, returns millions of operations per second.
+template <class Work>
+static double throughput(size_t threads, size_t operations, Work work)
+{
+    std::atomic<bool> go(false);
+    std::vector<std::thread> pool;
+    for (size_t t = 0; t < threads; t++)
+    {
+        pool.emplace_back([&, t] {
+            while (!go.load(std::memory_order_acquire))
+            {
+                std::this_thread::yield();
+            }
+            work(t);
+        });
+    }
+    auto start = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    for (std::thread& thread : pool)
+    {
+        thread.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return threads * operations / elapsed.count() / 1e6;
+}
+
+// Pushes a shuffled 0..count-1 and pops it all on one thread; a Fenwick tree over the
+// keys still queued gives the rank of every popped key.
+static void rankError(size_t heaps, size_t count)
+{
+    ConcurrentPriorityQueue<size_t> queue(heaps, 1);
+    std::vector<size_t> keys(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        keys[i] = i;
+    }
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(7));
+    std::vector<size_t> tree(count + 1, 0);
+    for (size_t key : keys)
+    {
+        queue.push(key);
+        for (size_t i = key + 1; i <= count; i += i & (0 - i))
+        {
+            tree[i]++;
+        }
+    }
+    double total = 0;
+    size_t worst = 0;
+    size_t key;
+    while (queue.try_pop(key))
+    {
+        size_t rank = 0; // queued keys smaller than key
+        for (size_t i = key; i > 0; i -= i & (0 - i))
+        {
+            rank += tree[i];
+        }
+        for (size_t i = key + 1; i <= count; i += i & (0 - i))
+        {
+            tree[i]--;
+        }
+        total += rank;
+        worst = rank > worst ? rank : worst;
+    }
+    std::printf("%8zu %16.2f %16zu\n", heaps, total / count, worst);
+}
+
+int main(int argc, char** argv)
+{
+    size_t operations = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200000;
+    size_t elements = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1000000;
+
+    std::printf("%8s %24s %24s\n", "threads", "ConcurrentPQ Mop/s", "PriorityQueue+mutex Mop/s");
+    for (size_t threads = 1; threads <= 32; threads *= 2)
+    {
+        ConcurrentPriorityQueue<unsigned> relaxed(threads);
+        PriorityQueue<unsigned> exact;
+        std::mutex lock;
+        for (unsigned i = 0; i < 4096; i++)
+        {
+            relaxed.push(i * 2654435761u);
+            exact.push(i * 2654435761u);
+        }
+        double multi = throughput(threads, operations, [&](size_t t) {
+            std::minstd_rand rng((unsigned) t + 1);
+            unsigned value;
+            for (size_t i = 0; i < operations; i += 2)
+            {
+                relaxed.push((unsigned) rng());
+                relaxed.try_pop(value);
+            }
+        });
+        double mutex = throughput(threads, operations, [&](size_t t) {
+            std::minstd_rand rng((unsigned) t + 1);
+            for (size_t i = 0; i < operations; i += 2)
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                exact.push((unsigned) rng());
+                exact.pop();
+            }
+        });
+        std::printf("%8zu %24.2f %24.2f\n", threads, multi, mutex);
+    }
+
+    std::printf("\n%8s %16s %16s\n", "heaps", "mean rank error", "max rank error");
+    for (size_t heaps = 2; heaps <= 64; heaps *= 2)
+    {
+        rankError(heaps, elements);
+    }
+    return 0;
+}
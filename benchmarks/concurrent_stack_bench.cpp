@@ -0,0 +1,78 @@
+// Contention benchmark for ConcurrentStack against a mutex guarded Stack: every thread
+// pushes and pops in turn on one shared stack, from 1 up to 64 threads.
+// Usage: concurrent_stack_bench [operations per thread]
+#include "../concurrent_stack.h"
+#include "../stack.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Starts threads copies of work together, returns millions of operations per second.
+template <class Work>
+static double throughput(size_t threads, size_t operations, Work work)
+{
+    std::atomic<bool> go(false);
+    std::vector<std::thread> pool;
+    for (size_t t = 0; t < threads; t++)
+    {
+        pool.emplace_back([&, t] {
+            while (!go.load(std::memory_order_acquire))
+            {
+                std::this_thread::yield();
+            }
+            work(t);
+        });
+    }
+    auto start = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    for (std::thread& thread : pool)
+    {
+        thread.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return threads * operations / elapsed.count() / 1e6;
+}
+
+int main(int argc, char** argv)
+{
+    size_t operations = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200000;
+    std::printf("%8s %22s %22s\n", "threads", "ConcurrentStack Mop/s", "Stack + mutex Mop/s");
+    for (size_t threads = 1; threads <= 64; threads *= 2)
+    {
+        ConcurrentStack<size_t> stack;
+        for (size_t i = 0; i < 1024; i++)
+        {
+            stack.push(i);
+        }
+        double lockFree = throughput(threads, operations, [&](size_t t) {
+            size_t value = t;
+            for (size_t i = 0; i < operations; i += 2)
+            {
+                stack.push(value);
+                stack.try_pop(value);
+            }
+        });
+
+        Stack<size_t> locked;
+        std::mutex lock;
+        for (size_t i = 0; i < 1024; i++)
+        {
+            locked.push(i);
+        }
+        double mutex = throughput(threads, operations, [&](size_t t) {
+            size_t value = t;
+            for (size_t i = 0; i < operations; i += 2)
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                locked.push(value);
+                value = locked.pop();
+            }
+        });
+        std::printf("%8zu %22.2f %22.2f\n", threads, lockFree, mutex);
+    }
+    return 0;
+}
@@ -0,0 +1,50 @@
+// Push and pop throughput of PriorityQueue on the binary heap against 4-ary and 8-ary
+// heaps, with the queue large enough that percolating down misses the cache.
+// Usage: dary_heap_bench [elements]
+#include "../priority_queue.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+template <class Queue>
+static void measure(const char* name, const std::vector<unsigned>& values)
+{
+    Queue queue;
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned value : values)
+    {
+        queue.push(value);
+    }
+    auto pushed = std::chrono::steady_clock::now();
+    bool ordered = true;
+    unsigned last = 0;
+    while (!queue.empty())
+    {
+        ordered = ordered && queue.top() >= last;
+        last = queue.top();
+        queue.pop();
+    }
+    auto popped = std::chrono::steady_clock::now();
+    std::chrono::duration<double> pushTime = pushed - start;
+    std::chrono::duration<double> popTime = popped - pushed;
+    std::printf("%-16s %12.2f %12.2f%s\n", name, values.size() / pushTime.count() / 1e6,
+                values.size() / popTime.count() / 1e6, ordered ? "" : "  (out of order)");
+}
+
+int main(int argc, char** argv)
+{
+    size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+    std::mt19937 rng(42);
+    std::vector<unsigned> values(count);
+    for (unsigned& value : values)
+    {
+        value = rng();
+    }
+    std::printf("%-16s %12s %12s\n", "heap", "push M/s", "pop M/s");
+    measure<PriorityQueue<unsigned>>("binary", values);
+    measure<DaryHeap<unsigned, 4>>("4-ary", values);
+    measure<DaryHeap<unsigned, 8>>("8-ary", values);
+    return 0;
+}
@@ -0,0 +1,133 @@
+// Hands items from one thread to another through SpscQueue, one at a time and in
+// batches, and through a mutex guarded Queue for comparison.
+// Usage: spsc_queue_bench [items]
+#include "../queue.h"
+#include "../spsc_queue.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+
+static const size_t Batch = 64;
+
+// Runs produce on a second thread and consume on this one, returns millions of items per second.
+template <class Produce, class Consume>
+static double throughput(size_t items, Produce produce, Consume consume)
+{
+    auto start = std::chrono::steady_clock::now();
+    std::thread producer(produce);
+    consume();
+    producer.join();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return items / elapsed.count() / 1e6;
+}
+
+static void report(const char* name, double rate, unsigned long long sum, unsigned long long expected)
+{
+    std::printf("%-24s %10.1f M items/s%s\n", name, rate, sum == expected ? "" : "  (checksum mismatch)");
+}
+
+int main(int argc, char** argv)
+{
+    size_t items = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+    unsigned long long expected = (unsigned long long) items * (items - 1) / 2;
+
+    {
+        SpscQueue<size_t> queue(1024);
+        unsigned long long sum = 0;
+        double rate = throughput(items,
+            [&] {
+                for (size_t i = 0; i < items; i++)
+                {
+                    queue.enqueue(i);
+                }
+            },
+            [&] {
+                for (size_t i = 0; i < items; i++)
+                {
+                    sum += queue.dequeue();
+                }
+            });
+        report("SpscQueue", rate, sum, expected);
+    }
+
+    {
+        SpscQueue<size_t> queue(1024);
+        unsigned long long sum = 0;
+        double rate = throughput(items,
+            [&] {
+                size_t values[Batch];
+                for (size_t next = 0; next < items;)
+                {
+                    size_t count = items - next < Batch ? items - next : Batch;
+                    for (size_t i = 0; i < count; i++)
+                    {
+                        values[i] = next + i;
+                    }
+                    size_t written = 0;
+                    while (written < count)
+                    {
+                        size_t now = queue.enqueue_n(values + written, count - written);
+                        if (now == 0)
+                        {
+                            std::this_thread::yield();
+                        }
+                        written += now;
+                    }
+                    next += count;
+                }
+            },
+            [&] {
+                size_t values[Batch];
+                for (size_t received = 0; received < items;)
+                {
+                    size_t taken = queue.dequeue_n(values, Batch);
+                    if (taken == 0)
+                    {
+                        std::this_thread::yield();
+                    }
+                    for (size_t i = 0; i < taken; i++)
+                    {
+                        sum += values[i];
+                    }
+                    received += taken;
+                }
+            });
+        report("SpscQueue, batches of 64", rate, sum, expected);
+    }
+
+    {
+        Queue<size_t> queue;
+        std::mutex lock;
+        unsigned long long sum = 0;
+        double rate = throughput(items,
+            [&] {
+                for (size_t i = 0; i < items; i++)
+                {
+                    std::lock_guard<std::mutex> guard(lock);
+                    queue.enqueue(i);
+                }
+            },
+            [&] {
+                for (size_t received = 0; received < items;)
+                {
+                    size_t value;
+                    bool got;
+                    {
+                        std::lock_guard<std::mutex> guard(lock);
+                        got = queue.try_dequeue(value);
+                    }
+                    if (!got)
+                    {
+                        std::this_thread::yield();
+                        continue;
+                    }
+                    sum += value;
+                    received++;
+                }
+            });
+        report("Queue + mutex", rate, sum, expected);
+    }
+    return 0;
+}
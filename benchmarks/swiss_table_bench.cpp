@@ -0,0 +1,88 @@
+// Inserts, hits, misses and removals on SwissTable against the Robin Hood HashTable from
+// hashtable_open_addressing.h and std::unordered_set, all with the same random keys.
+// Usage: swiss_table_bench [keys]
+#include "../hashtable_open_addressing.h"
+#include "../hashtable_swiss_table.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <unordered_set>
+#include <vector>
+
+static double millionsPerSecond(size_t count, std::chrono::steady_clock::time_point start)
+{
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return count / elapsed.count() / 1e6;
+}
+
+// present are inserted, absent are never in the table.
+template <class Set>
+static void measure(const char* name, const std::vector<uint64_t>& present, const std::vector<uint64_t>& absent)
+{
+    Set set;
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t key : present)
+    {
+        set.insert(key);
+    }
+    double insert = millionsPerSecond(present.size(), start);
+
+    size_t found = 0;
+    start = std::chrono::steady_clock::now();
+    for (uint64_t key : present)
+    {
+        found += set.count(key);
+    }
+    double hit = millionsPerSecond(present.size(), start);
+
+    start = std::chrono::steady_clock::now();
+    for (uint64_t key : absent)
+    {
+        found += set.count(key);
+    }
+    double miss = millionsPerSecond(absent.size(), start);
+
+    size_t removed = 0;
+    start = std::chrono::steady_clock::now();
+    for (uint64_t key : present)
+    {
+        removed += set.erase(key);
+    }
+    double remove = millionsPerSecond(present.size(), start);
+
+    bool right = found == present.size() && removed == present.size();
+    std::printf("%-24s %10.2f %10.2f %10.2f %10.2f%s\n", name, insert, hit, miss, remove, right ? "" : "  (wrong result)");
+}
+
+// Gives the repo tables the unordered_set spelling used above.
+template <class Table>
+struct Adapted : Table {
+    size_t count(uint64_t key) const
+    {
+        return this->contains(key) ? 1 : 0;
+    }
+    size_t erase(uint64_t key)
+    {
+        return this->remove(key);
+    }
+};
+
+int main(int argc, char** argv)
+{
+    size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    std::mt19937_64 rng(1);
+    std::vector<uint64_t> present(count);
+    std::vector<uint64_t> absent(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        present[i] = rng() | 1; // odd keys go in, even keys always miss
+        absent[i] = rng() & ~(uint64_t) 1;
+    }
+    std::printf("%-24s %10s %10s %10s %10s\n", "M ops/s", "insert", "hit", "miss", "remove");
+    measure<Adapted<SwissTable<uint64_t>>>("SwissTable", present, absent);
+    measure<Adapted<HashTable<uint64_t>>>("HashTable (Robin Hood)", present, absent);
+    measure<std::unordered_set<uint64_t>>("std::unordered_set", present, absent);
+    return 0;
+}
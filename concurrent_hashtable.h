@@ -0,0 +1,349 @@
+#ifndef CONCURRENT_HASHTABLE_H
+#define CONCURRENT_HASHTABLE_H
+
+#include "epoch_reclamation.h"
+#include "node_pool.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+// Separate chaining hash set for any number of threads.
+// Writers lock one of a fixed number of stripes, picked by hash % stripes; the bucket
+// count is always a multiple of the stripe count, so every bucket belongs to exactly one
+// stripe and writers on different stripes never wait for each other. Hashes are mixed
+// first, so keys std::hash tells apart only in the high bits still use every stripe.
+// contains takes no lock at all: it pins an epoch and walks the chain, and removed nodes
+// are only freed once no pinned reader can still be on them.
+// Growing hangs a bucket array twice the size off the current one and moves the stripes
+// over one at a time, each under its own lock only; an insert that reaches a stripe not
+// moved yet moves it first. Nodes are copied rather than relinked, so readers still on
+// an old chain see it frozen as it was, and the old array is freed with its nodes once
+// the last stripe has moved and no reader can be on it. Keys therefore have to be copyable.
+// Nodes come from the shared node pool, which outlives every retired node.
+template <class Key, class Hash=std::hash<Key>, class KeyEqual=std::equal_to<Key>>
+class ConcurrentHashTable {
+    private:
+        static constexpr size_t CacheLine = 64;
+
+        struct Node {
+            Key key;
+            size_t hash;
+            std::atomic<Node*> next;
+
+            template <class K>
+            Node(std::in_place_t, size_t h, K&& k) : key(std::forward<K>(k)), hash(h), next(nullptr) {}
+        };
+        using NodeAllocator = PoolAllocator<Node>;
+        using NodeTraits = std::allocator_traits<NodeAllocator>;
+
+        struct BucketArray {
+            size_t size;
+            std::unique_ptr<std::atomic<Node*>[]> heads;
+            std::atomic<BucketArray*> next; // the bigger array being moved into
+            std::unique_ptr<std::atomic<bool>[]> moved; // per stripe, its buckets live in next now
+            std::atomic<size_t> pending; // stripes not moved yet
+
+            BucketArray(size_t n, size_t stripes)
+                : size(n), heads(new std::atomic<Node*>[n]), next(nullptr), moved(new std::atomic<bool>[stripes]), pending(stripes)
+            {
+                for (size_t i = 0; i < n; i++)
+                {
+                    heads[i].store(nullptr, std::memory_order_relaxed);
+                }
+                for (size_t i = 0; i < stripes; i++)
+                {
+                    moved[i].store(false, std::memory_order_relaxed);
+                }
+            }
+        };
+
+        struct alignas(CacheLine) Stripe {
+            std::mutex lock;
+            std::atomic<size_t> count; // elements in the buckets of this stripe
+        };
+
+        Hash hasher;
+        KeyEqual equal;
+        float maxLoad;
+        size_t stripeCount;
+        std::unique_ptr<Stripe[]> stripes;
+        alignas(CacheLine) std::atomic<BucketArray*> buckets;
+
+    public:
+        explicit ConcurrentHashTable(size_t stripes = 64, size_t capacity = 0)
+            : hasher(), equal(), maxLoad(1), stripeCount(stripes == 0 ? 1 : stripes), stripes(), buckets(nullptr)
+        {
+            this->stripes.reset(new Stripe[stripeCount]);
+            for (size_t i = 0; i < stripeCount; i++)
+            {
+                this->stripes[i].count.store(0, std::memory_order_relaxed);
+            }
+            size_t bucketCount = stripeCount;
+            while (bucketCount < capacity / maxLoad)
+            {
+                bucketCount *= 2;
+            }
+            buckets.store(new BucketArray(bucketCount, stripeCount), std::memory_order_release);
+        }
+        ConcurrentHashTable(const ConcurrentHashTable& other) = delete;
+        ConcurrentHashTable& operator=(const ConcurrentHashTable& other) = delete;
+        // No other thread may be using the table by now.
+        ~ConcurrentHashTable() {
+            BucketArray* array = buckets.load(std::memory_order_relaxed);
+            while (array != nullptr)
+            {
+                BucketArray* next = array->next.load(std::memory_order_relaxed);
+                destroyArray(array);
+                array = next;
+            }
+        }
+
+        // Only a snapshot while other threads are running.
+        size_t size() const {
+            size_t total = 0;
+            for (size_t i = 0; i < stripeCount; i++)
+            {
+                total += stripes[i].count.load(std::memory_order_relaxed);
+            }
+            return total;
+        }
+        bool is_empty() const {
+            return size() == 0;
+        }
+        size_t bucket_count() const {
+            EpochReclamation::Guard guard;
+            return buckets.load(std::memory_order_acquire)->size;
+        }
+        size_t stripe_count() const {
+            return stripeCount;
+        }
+
+        bool insert(const Key& key) {
+            return emplaceKey(key);
+        }
+        bool insert(Key&& key) {
+            return emplaceKey(std::move(key));
+        }
+
+        bool contains(const Key& key) const {
+            size_t hash = mix(hasher(key));
+            EpochReclamation::Guard guard;
+            const BucketArray* array = arrayFor(hash % stripeCount);
+            for (Node* node = array->heads[hash % array->size].load(std::memory_order_acquire); node != nullptr;
+                 node = node->next.load(std::memory_order_acquire))
+            {
+                if (node->hash == hash && equal(node->key, key))
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        size_t remove(const Key& key) {
+            size_t hash = mix(hasher(key));
+            Node* removed = nullptr;
+            {
+                EpochReclamation::Guard epoch;
+                Stripe& stripe = stripes[hash % stripeCount];
+                std::lock_guard<std::mutex> guard(stripe.lock);
+                // an unmoved stripe is fine to remove from, no need to allocate for a move
+                BucketArray* array = arrayFor(hash % stripeCount);
+                std::atomic<Node*>* link = &array->heads[hash % array->size];
+                for (Node* node = link->load(std::memory_order_relaxed); node != nullptr; node = link->load(std::memory_order_relaxed))
+                {
+                    if (node->hash == hash && equal(node->key, key))
+                    {
+                        // readers on the node can still follow its next pointer
+                        link->store(node->next.load(std::memory_order_relaxed), std::memory_order_release);
+                        stripe.count.store(stripe.count.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+                        removed = node;
+                        break;
+                    }
+                    link = &node->next;
+                }
+            }
+            if (removed == nullptr)
+            {
+                return 0;
+            }
+            EpochReclamation::retire(removed, &retireNode);
+            return 1;
+        }
+
+    private:
+        template <class K>
+        bool emplaceKey(K&& key) {
+            size_t hash = mix(hasher(key));
+            EpochReclamation::Guard epoch; // keeps array alive after the lock is gone
+            BucketArray* array;
+            size_t count;
+            {
+                Stripe& stripe = stripes[hash % stripeCount];
+                std::lock_guard<std::mutex> guard(stripe.lock);
+                array = movedArray(hash % stripeCount);
+                std::atomic<Node*>& head = array->heads[hash % array->size];
+                for (Node* node = head.load(std::memory_order_relaxed); node != nullptr; node = node->next.load(std::memory_order_relaxed))
+                {
+                    if (node->hash == hash && equal(node->key, key))
+                    {
+                        return false;
+                    }
+                }
+                Node* node = createNode(hash, std::forward<K>(key));
+                node->next.store(head.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                head.store(node, std::memory_order_release); // publishes the node to readers
+                count = stripe.count.load(std::memory_order_relaxed) + 1;
+                stripe.count.store(count, std::memory_order_relaxed);
+            }
+            size_t bucketCount = array->size;
+            // a stripe past its share of the load only hints at growing, the sum over every
+            // stripe decides, so one crowded stripe cannot blow up the whole array
+            if (count > bucketCount / stripeCount * maxLoad && size() > bucketCount * maxLoad)
+            {
+                grow(array);
+            }
+            return true;
+        }
+
+        // Hangs an array twice the size off array and moves every stripe into it, unless
+        // array is no longer the current one or is already being grown.
+        void grow(BucketArray* array) {
+            if (buckets.load(std::memory_order_acquire) != array || array->next.load(std::memory_order_acquire) != nullptr)
+            {
+                return;
+            }
+            // built before any lock is taken, nothing reaches it until a stripe has moved
+            BucketArray* bigger = new BucketArray(array->size * 2, stripeCount);
+            BucketArray* expected = nullptr;
+            if (!array->next.compare_exchange_strong(expected, bigger, std::memory_order_acq_rel, std::memory_order_acquire))
+            {
+                delete bigger;
+                return;
+            }
+            for (size_t i = 0; i < stripeCount; i++)
+            {
+                std::lock_guard<std::mutex> guard(stripes[i].lock);
+                movedArray(i);
+            }
+        }
+
+        // The array holding the buckets of the given stripe right now. Needs a pinned epoch.
+        BucketArray* arrayFor(size_t stripe) const {
+            BucketArray* array = buckets.load(std::memory_order_acquire);
+            while (array->moved[stripe].load(std::memory_order_acquire))
+            {
+                array = array->next.load(std::memory_order_relaxed); // set before any stripe moves
+            }
+            return array;
+        }
+        // Like arrayFor, but first moves the stripe into any bigger array waiting for it.
+        // Needs the stripe lock and a pinned epoch.
+        BucketArray* movedArray(size_t stripe) {
+            BucketArray* array = buckets.load(std::memory_order_acquire);
+            for (BucketArray* next = array->next.load(std::memory_order_acquire); next != nullptr;
+                 next = array->next.load(std::memory_order_acquire))
+            {
+                if (!array->moved[stripe].load(std::memory_order_relaxed))
+                {
+                    moveStripe(array, next, stripe);
+                }
+                array = next;
+            }
+            return array;
+        }
+        // Copies the chains of one stripe from into to, leaving them in from untouched.
+        // Whoever moves the last stripe makes to the current array. Needs the stripe lock.
+        void moveStripe(BucketArray* from, BucketArray* to, size_t stripe) {
+            try
+            {
+                for (size_t i = stripe; i < from->size; i += stripeCount)
+                {
+                    for (Node* node = from->heads[i].load(std::memory_order_relaxed); node != nullptr;
+                         node = node->next.load(std::memory_order_relaxed))
+                    {
+                        Node* copy = createNode(node->hash, node->key);
+                        std::atomic<Node*>& head = to->heads[node->hash % to->size]; // same stripe
+                        copy->next.store(head.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                        head.store(copy, std::memory_order_relaxed);
+                    }
+                }
+            }
+            catch (...)
+            {
+                // nobody looks at these buckets of to before the stripe is marked moved
+                for (size_t i = stripe; i < to->size; i += stripeCount)
+                {
+                    destroyChain(to->heads[i].exchange(nullptr, std::memory_order_relaxed));
+                }
+                throw;
+            }
+            from->moved[stripe].store(true, std::memory_order_release);
+            if (from->pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                buckets.store(to, std::memory_order_release);
+                EpochReclamation::retire(from, &retireArray);
+            }
+        }
+
+        // xor-shift-multiply finalizer: every input bit reaches the low bits used for
+        // picking stripes and buckets.
+        static size_t mix(size_t h) {
+            uint64_t x = (uint64_t) h;
+            x ^= x >> 33;
+            x *= 0xFF51AFD7ED558CCDull;
+            x ^= x >> 33;
+            x *= 0xC4CEB9FE1A85EC53ull;
+            x ^= x >> 33;
+            return (size_t) x;
+        }
+
+        template <class K>
+        static Node* createNode(size_t hash, K&& key) {
+            NodeAllocator alloc;
+            Node* node = NodeTraits::allocate(alloc, 1);
+            try
+            {
+                NodeTraits::construct(alloc, node, std::in_place, hash, std::forward<K>(key));
+            }
+            catch (...)
+            {
+                NodeTraits::deallocate(alloc, node, 1);
+                throw;
+            }
+            return node;
+        }
+        static void destroyNode(Node* node) {
+            NodeAllocator alloc;
+            NodeTraits::destroy(alloc, node);
+            NodeTraits::deallocate(alloc, node, 1);
+        }
+        static void retireNode(void* node) {
+            destroyNode(static_cast<Node*>(node));
+        }
+        static void destroyChain(Node* node) {
+            while (node != nullptr)
+            {
+                Node* next = node->next.load(std::memory_order_relaxed);
+                destroyNode(node);
+                node = next;
+            }
+        }
+        // Frees an array together with every node still linked from it, not the array after it.
+        static void destroyArray(BucketArray* array) {
+            for (size_t i = 0; i < array->size; i++)
+            {
+                destroyChain(array->heads[i].load(std::memory_order_relaxed));
+            }
+            delete array;
+        }
+        static void retireArray(void* array) {
+            destroyArray(static_cast<BucketArray*>(array));
+        }
+};
+
+#endif  // CONCURRENT_HASHTABLE_H
@@ -0,0 +1,177 @@
+#ifndef CONCURRENT_PRIORITY_QUEUE_H
+#define CONCURRENT_PRIORITY_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "heap.h"
+
+// Relaxed concurrent priority queue (MultiQueue). Elements are spread over
+// relaxation * threads small heaps, each behind its own lock. push goes to a random heap,
+// try_pop locks two random heaps and pops the better of their tops, so threads rarely
+// meet on the same lock. The price is that try_pop may return an element that is not
+// the global top; with two choices the expected rank error grows with the number of
+// heaps, so a smaller relaxation factor trades throughput for accuracy.
+// Same ordering as PriorityQueue: comp(a, b) means a comes out first.
+template <class Comparable, class Compare=std::less<Comparable>, class HeapPolicy=BinaryHeapPolicy>
+class ConcurrentPriorityQueue {
+    private:
+        static constexpr size_t CacheLine = 64;
+
+        struct alignas(CacheLine) Lane {
+            std::mutex lock;
+            std::vector<Comparable> heap;
+            std::atomic<size_t> count; // readable without the lock, to skip empty heaps
+        };
+
+        Compare compare;
+        size_t laneCount;
+        std::unique_ptr<Lane[]> lanes;
+
+    public:
+        explicit ConcurrentPriorityQueue(size_t threads = std::thread::hardware_concurrency(), size_t relaxation = 2,
+                                         const Compare& comp = Compare())
+            : compare(comp), laneCount(0), lanes()
+        {
+            laneCount = (threads == 0 ? 1 : threads) * (relaxation == 0 ? 1 : relaxation);
+            if (laneCount < 2)
+            {
+                laneCount = 2;
+            }
+            lanes.reset(new Lane[laneCount]);
+            for (size_t i = 0; i < laneCount; i++)
+            {
+                lanes[i].count.store(0, std::memory_order_relaxed);
+            }
+        }
+        ConcurrentPriorityQueue(const ConcurrentPriorityQueue& other) = delete;
+        ConcurrentPriorityQueue& operator=(const ConcurrentPriorityQueue& other) = delete;
+
+        size_t heap_count() const {
+            return laneCount;
+        }
+        // Only a snapshot while other threads are running.
+        size_t size() const {
+            size_t total = 0;
+            for (size_t i = 0; i < laneCount; i++)
+            {
+                total += lanes[i].count.load(std::memory_order_relaxed);
+            }
+            return total;
+        }
+        bool empty() const {
+            return size() == 0;
+        }
+
+        void push(const Comparable& value) {
+            Lane& lane = lockRandomLane();
+            std::lock_guard<std::mutex> guard(lane.lock, std::adopt_lock);
+            lane.heap.push_back(value);
+            finishPush(lane);
+        }
+        void push(Comparable&& value) {
+            Lane& lane = lockRandomLane();
+            std::lock_guard<std::mutex> guard(lane.lock, std::adopt_lock);
+            lane.heap.push_back(std::move(value));
+            finishPush(lane);
+        }
+
+        // Pops a near-top element. Returns false only after finding every heap empty.
+        bool try_pop(Comparable& out) {
+            for (size_t attempt = 0; attempt < laneCount; attempt++)
+            {
+                Lane& a = lanes[randomIndex()];
+                Lane& b = lanes[randomIndex()];
+                bool aEmpty = a.count.load(std::memory_order_relaxed) == 0;
+                bool bEmpty = b.count.load(std::memory_order_relaxed) == 0;
+                if (aEmpty && bEmpty)
+                {
+                    continue;
+                }
+                if (&a == &b || aEmpty || bEmpty)
+                {
+                    Lane& lane = aEmpty ? b : a;
+                    std::unique_lock<std::mutex> guard(lane.lock, std::try_to_lock);
+                    if (guard.owns_lock() && !lane.heap.empty())
+                    {
+                        popFrom(lane, out);
+                        return true;
+                    }
+                    continue;
+                }
+                if (std::try_lock(a.lock, b.lock) != -1)
+                {
+                    continue; // somebody is busy there, pick another pair
+                }
+                std::lock_guard<std::mutex> guardA(a.lock, std::adopt_lock);
+                std::lock_guard<std::mutex> guardB(b.lock, std::adopt_lock);
+                Lane* best = nullptr;
+                if (!a.heap.empty())
+                {
+                    best = &a;
+                }
+                if (!b.heap.empty() && (best == nullptr || compare(b.heap.front(), best->heap.front())))
+                {
+                    best = &b;
+                }
+                if (best != nullptr)
+                {
+                    popFrom(*best, out);
+                    return true;
+                }
+            }
+            // random picks kept missing, sweep every heap before reporting empty
+            for (size_t i = 0; i < laneCount; i++)
+            {
+                Lane& lane = lanes[i];
+                std::lock_guard<std::mutex> guard(lane.lock);
+                if (!lane.heap.empty())
+                {
+                    popFrom(lane, out);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+    private:
+        static size_t randomState() {
+            return std::hash<std::thread::id>()(std::this_thread::get_id()) | 1;
+        }
+        size_t randomIndex() {
+            thread_local size_t state = randomState();
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            return state % laneCount;
+        }
+
+        Lane& lockRandomLane() {
+            for (;;)
+            {
+                Lane& lane = lanes[randomIndex()];
+                if (lane.lock.try_lock())
+                {
+                    return lane;
+                }
+            }
+        }
+        // Called with lane locked and the new element at the back of its heap.
+        void finishPush(Lane& lane) {
+            HeapPolicy::push(lane.heap.begin(), lane.heap.end(), compare);
+            lane.count.store(lane.heap.size(), std::memory_order_relaxed);
+        }
+        void popFrom(Lane& lane, Comparable& out) {
+            HeapPolicy::pop(lane.heap.begin(), lane.heap.end(), compare);
+            out = std::move(lane.heap.back());
+            lane.heap.pop_back();
+            lane.count.store(lane.heap.size(), std::memory_order_relaxed);
+        }
+};
+
+#endif  // CONCURRENT_PRIORITY_QUEUE_H
@@ -0,0 +1,205 @@
+#ifndef CONCURRENT_STACK_H
+#define CONCURRENT_STACK_H
+
+#include "hazard_pointer.h"
+#include "node_pool.h"
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+// Lock-free Treiber stack for any number of threads.
+// Popped nodes go through hazard pointers before they are freed, so a thread that is
+// still looking at the old top can never see its node recycled under it (no ABA).
+// When the CAS on the top fails because of contention, push and pop meet in a small
+// elimination array instead: a push handed straight to a pop never touches the top.
+// Nodes come from the shared node pool, which outlives every retired node.
+template <typename Object>
+class ConcurrentStack {
+    private:
+        struct Node {
+            Object data;
+            Node* next;
+
+            template <class... Args>
+            explicit Node(std::in_place_t, Args&&... args) : data(std::forward<Args>(args)...), next(nullptr) {}
+        };
+        using NodeAllocator = PoolAllocator<Node>;
+        using NodeTraits = std::allocator_traits<NodeAllocator>;
+
+        static constexpr size_t CacheLine = 64;
+        static constexpr size_t EliminationSlots = 16;
+        static constexpr size_t EliminationSpins = 128;
+
+        struct alignas(CacheLine) Exchanger {
+            std::atomic<Node*> offer;
+        };
+
+        alignas(CacheLine) std::atomic<Node*> head;
+        Exchanger elimination[EliminationSlots];
+
+    public:
+        ConcurrentStack() : head(nullptr)
+        {
+            for (Exchanger& e : elimination)
+            {
+                e.offer.store(nullptr, std::memory_order_relaxed);
+            }
+        }
+        ConcurrentStack(const ConcurrentStack& other) = delete;
+        ConcurrentStack& operator=(const ConcurrentStack& other) = delete;
+        // No other thread may be using the stack by now.
+        ~ConcurrentStack() {
+            Node* node = head.load(std::memory_order_relaxed);
+            while (node != nullptr)
+            {
+                Node* next = node->next;
+                destroyNode(node);
+                node = next;
+            }
+        }
+
+        void push(const Object& other) {
+            emplace(other);
+        }
+        void push(Object&& other) {
+            emplace(std::move(other));
+        }
+        template <class... Args>
+        void emplace(Args&&... args) {
+            Node* node = createNode(std::forward<Args>(args)...);
+            node->next = head.load(std::memory_order_relaxed);
+            while (!head.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed))
+            {
+                if (eliminatePush(node))
+                {
+                    return;
+                }
+                node->next = head.load(std::memory_order_relaxed);
+            }
+        }
+
+        // Nodes can still be read through top() after they are unlinked, so the value is
+        // copied out and the node keeps its own until it is reclaimed.
+        bool try_pop(Object& out) {
+            for (;;)
+            {
+                Node* top = HazardPointers::protect(head);
+                if (top == nullptr)
+                {
+                    HazardPointers::clear();
+                    return false;
+                }
+                Node* next = top->next;
+                if (head.compare_exchange_strong(top, next))
+                {
+                    HazardPointers::clear();
+                    out = static_cast<const Object&>(top->data);
+                    HazardPointers::retire(top, &retireNode);
+                    return true;
+                }
+                HazardPointers::clear();
+                if (Node* given = eliminatePop())
+                {
+                    // never reachable by anyone else, safe to move from and free right away
+                    out = std::move(given->data);
+                    destroyNode(given);
+                    return true;
+                }
+            }
+        }
+        Object pop() {
+            Object top;
+            if (!try_pop(top))
+            {
+                throw std::out_of_range("");
+            }
+            return top;
+        }
+        // Returns a copy, the top may be popped by another thread at any moment.
+        Object top() const {
+            Node* node = HazardPointers::protect(head);
+            if (node == nullptr)
+            {
+                HazardPointers::clear();
+                throw std::out_of_range("");
+            }
+            Object copy(node->data);
+            HazardPointers::clear();
+            return copy;
+        }
+        // Only a snapshot while other threads are running.
+        bool empty() const {
+            return head.load(std::memory_order_acquire) == nullptr;
+        }
+
+    private:
+        template <class... Args>
+        static Node* createNode(Args&&... args) {
+            NodeAllocator alloc;
+            Node* node = NodeTraits::allocate(alloc, 1);
+            try
+            {
+                NodeTraits::construct(alloc, node, std::in_place, std::forward<Args>(args)...);
+            }
+            catch (...)
+            {
+                NodeTraits::deallocate(alloc, node, 1);
+                throw;
+            }
+            return node;
+        }
+        static void destroyNode(Node* node) {
+            NodeAllocator alloc;
+            NodeTraits::destroy(alloc, node);
+            NodeTraits::deallocate(alloc, node, 1);
+        }
+        static void retireNode(void* node) {
+            destroyNode(static_cast<Node*>(node));
+        }
+
+        Exchanger& randomExchanger() {
+            // cheap per thread xorshift, the slot only needs to spread contending threads
+            thread_local unsigned state = (unsigned) std::hash<std::thread::id>()(std::this_thread::get_id()) | 1u;
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            return elimination[state % EliminationSlots];
+        }
+
+        // Offers node in a random slot for a while. Returns true if a pop took it.
+        bool eliminatePush(Node* node) {
+            Exchanger& e = randomExchanger();
+            Node* expected = nullptr;
+            if (!e.offer.compare_exchange_strong(expected, node, std::memory_order_release, std::memory_order_relaxed))
+            {
+                return false;
+            }
+            for (size_t i = 0; i < EliminationSpins; i++)
+            {
+                if (e.offer.load(std::memory_order_relaxed) != node)
+                {
+                    return true;
+                }
+            }
+            // nobody came, take the offer back unless a pop grabbed it just now
+            expected = node;
+            return !e.offer.compare_exchange_strong(expected, nullptr, std::memory_order_relaxed);
+        }
+
+        // Takes whatever a concurrent push left in a random slot.
+        Node* eliminatePop() {
+            Exchanger& e = randomExchanger();
+            Node* offered = e.offer.load(std::memory_order_relaxed);
+            if (offered != nullptr && e.offer.compare_exchange_strong(offered, nullptr, std::memory_order_acquire, std::memory_order_relaxed))
+            {
+                return offered;
+            }
+            return nullptr;
+        }
+};
+
+#endif  // CONCURRENT_STACK_H
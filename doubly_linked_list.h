@@ -1,64 +1,133 @@
 #ifndef DOUBLY_LINKED_LIST_H
 #define DOUBLY_LINKED_LIST_H
 
+#include "node_pool.h"
 #include <cstddef>
 #include <iostream>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
 #include <stdexcept> 
 #include <utility>
 
-template <typename Object>
+template <typename Object, class Allocator = PoolAllocator<Object>>
 class DoublyLinkedList {
     private:
         struct Node {
             Object data;
             Node* next;
             Node* prev;
+
+            template <class... Args>
+            explicit Node(std::in_place_t, Args&&... args) : data(std::forward<Args>(args)...), next(nullptr), prev(nullptr) {}
         };
+        using NodeAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Node>;
+        using NodeTraits = std::allocator_traits<NodeAllocator>;
+
+        NodeAllocator nodeAlloc;
         size_t _size;
         Node* _head;
         Node* _tail;
-        Node* _marker;
-        Node* _shadow;
+        size_t _version; // bumped on every structural change, lets fingers spot stale positions
+
+        // end() holds a null node, so iterators also carry the list to step back from it
+        template <bool Const>
+        class Iterator {
+            private:
+                friend class DoublyLinkedList;
+                Node* node;
+                const DoublyLinkedList* list;
+                Iterator(Node* n, const DoublyLinkedList* l) : node(n), list(l) {}
+            public:
+                using iterator_category = std::bidirectional_iterator_tag;
+                using value_type = Object;
+                using difference_type = std::ptrdiff_t;
+                using pointer = std::conditional_t<Const, const Object*, Object*>;
+                using reference = std::conditional_t<Const, const Object&, Object&>;
+
+                Iterator() : node(nullptr), list(nullptr) {}
+                template <bool WasConst, class = std::enable_if_t<Const && !WasConst>>
+                Iterator(const Iterator<WasConst>& other) : node(other.node), list(other.list) {}
+
+                reference operator*() const {
+                    return node->data;
+                }
+                pointer operator->() const {
+                    return &node->data;
+                }
+                Iterator& operator++() {
+                    node = node->next;
+                    return *this;
+                }
+                Iterator operator++(int) {
+                    Iterator old = *this;
+                    node = node->next;
+                    return old;
+                }
+                Iterator& operator--() {
+                    node = (node == nullptr) ? list->_tail : node->prev;
+                    return *this;
+                }
+                Iterator operator--(int) {
+                    Iterator old = *this;
+                    --(*this);
+                    return old;
+                }
+                template <bool OtherConst>
+                bool operator==(const Iterator<OtherConst>& other) const {
+                    return node == other.node;
+                }
+                template <bool OtherConst>
+                bool operator!=(const Iterator<OtherConst>& other) const {
+                    return node != other.node;
+                }
+        };
     public:
-        DoublyLinkedList <Object>() : _size(0), _head(nullptr), _tail(nullptr), _marker(nullptr), _shadow(nullptr) {}
-        DoublyLinkedList(const DoublyLinkedList& other) : _size(other._size), _head(nullptr), _tail(nullptr), _marker(nullptr), _shadow(nullptr) 
+        using allocator_type = Allocator;
+        using node_allocator_type = NodeAllocator;
+        using iterator = Iterator<false>;
+        using const_iterator = Iterator<true>;
+
+        DoublyLinkedList() : nodeAlloc(), _size(0), _head(nullptr), _tail(nullptr), _version(0) {}
+        explicit DoublyLinkedList(const Allocator& alloc) : nodeAlloc(alloc), _size(0), _head(nullptr), _tail(nullptr), _version(0) {}
+        DoublyLinkedList(const DoublyLinkedList& other)
+            : nodeAlloc(NodeTraits::select_on_container_copy_construction(other.nodeAlloc)), _size(0), _head(nullptr), _tail(nullptr), _version(0)
         {
-            if (_size == 0)
+            for (const Node* node = other._head; node != nullptr; node = node->next)
             {
-                return;
+                linkBefore(nullptr, createNode(node->data));
             }
-            Node* newHead = new Node;
-            newHead->data = other._head->data;
-            newHead->prev = nullptr;
-            _head = newHead;
-            _head->next = nullptr;
-
-            _marker = _head;
-            Node* secondMarker = other._head;
-            while (secondMarker->next != nullptr)
+        }
+        DoublyLinkedList(DoublyLinkedList&& other) noexcept
+            : nodeAlloc(std::move(other.nodeAlloc)), _size(0), _head(nullptr), _tail(nullptr), _version(0)
+        {
+            takeNodes(other);
+        }
+        DoublyLinkedList(DoublyLinkedList&& other, const Allocator& alloc)
+            : nodeAlloc(alloc), _size(0), _head(nullptr), _tail(nullptr), _version(0)
+        {
+            if (nodeAlloc == other.nodeAlloc)
             {
-                secondMarker = secondMarker->next;
-                Node* newNode = new Node;
-                newNode->data = secondMarker->data;
-                newNode->next = nullptr;
-                newNode->prev = _marker;
-                _marker->next = newNode;
-                _marker = newNode;
+                takeNodes(other);
+                return;
             }
-            _tail = _marker;
+            moveElementsFrom(other);
         }
         ~DoublyLinkedList() {
             clear();
         }
         void clear() { // Destructor helper
-            _marker = _head;
-            while (_head != nullptr)
+            Node* node = _head;
+            while (node != nullptr)
             {
-                _marker = _marker->next;
-                delete _head;
-                _head = _marker;
-                _size--;
+                Node* next = node->next;
+                destroyNode(node);
+                node = next;
             }
+            _head = nullptr;
+            _tail = nullptr;
+            _size = 0;
+            _version++;
         }
         DoublyLinkedList& operator=(const DoublyLinkedList& other)
         {
@@ -68,70 +137,74 @@ class DoublyLinkedList {
             }
             
             this->clear();
-            _head = nullptr;
-            _tail = nullptr;
-            _marker = nullptr;
-            _shadow = nullptr;
-            if (other._size == 0) // Setting it equal to empty list
+            if constexpr (NodeTraits::propagate_on_container_copy_assignment::value)
             {
-                _size = other._size;
-                return *this;
+                nodeAlloc = other.nodeAlloc; // no nodes left that the old one would have to free
+            }
+            for (const Node* node = other._head; node != nullptr; node = node->next)
+            {
+                linkBefore(nullptr, createNode(node->data));
             }
-            _size = other._size;
-
-            Node* newHead = new Node;
-            newHead->data = other._head->data;
-            newHead->prev = nullptr;
-            _head = newHead;
-            _head->next = nullptr;
-
-            _marker = _head;
-             Node* secondMarker = other._head;
-            while (secondMarker->next != nullptr)
-            {
-                secondMarker = secondMarker->next;
-                Node* newNode = new Node;
-                newNode->data = secondMarker->data;
-                newNode->next = nullptr;
-                newNode->prev = _marker;
-                _marker->next = newNode;
-                _marker = newNode;
-            }
-            _tail = _marker;
             return *this;
         }
-        size_t size() {
-            return _size;
-        }
-        Object& operator[](size_t index) {
-            if (index >= _size || index < 0)
+        DoublyLinkedList& operator=(DoublyLinkedList&& other) noexcept(NodeTraits::propagate_on_container_move_assignment::value
+                                                                       || NodeTraits::is_always_equal::value)
+        {
+            if (this == &other)
             {
-                throw std::out_of_range("");
+                return *this;
             }
-            if (index == 0)
+            this->clear();
+            if (!NodeTraits::propagate_on_container_move_assignment::value && nodeAlloc != other.nodeAlloc)
             {
-                return _head->data;
+                // can't adopt nodes from a different resource, move the elements over instead
+                moveElementsFrom(other);
+                return *this;
             }
-            size_t i;
-            if ((_size - 1) - index >= (_size / 2)) { //start at head
-                _marker = _head;
-                i = 0;
-                while (i != index) {
-                    i++;
-                    _marker = _marker->next;
-                }
-                return _marker->data;
+            if constexpr (NodeTraits::propagate_on_container_move_assignment::value)
+            {
+                nodeAlloc = std::move(other.nodeAlloc);
             }
-            else { //start at tail
-                _marker = _tail;
-                i = _size - 1;
-                while (i != index)
-                {
-                    i--;
-                    _marker = _marker->prev;
+            takeNodes(other);
+            return *this;
+        }
+        Allocator get_allocator() const {
+            return Allocator(nodeAlloc);
+        }
+        size_t size() const {
+            return _size;
+        }
+        // Walks from whichever end is closer. Reads don't touch the list, so any
+        // number of threads may read at once as long as nobody writes.
+        Object& operator[](size_t index) {
+            return nodeAt(index, nullptr, 0)->data;
+        }
+        const Object& operator[](size_t index) const {
+            return nodeAt(index, nullptr, 0)->data;
+        }
+
+        // Caller owned cursor for indexed access. Each at() starts from the closest of
+        // head, tail or the finger's last position, so stepping through indices in
+        // order is O(1) per call. Give every reader thread its own finger; a finger
+        // notices when the list's structure changed and falls back to head/tail.
+        class Finger {
+            private:
+                friend class DoublyLinkedList;
+                Node* node;
+                size_t index;
+                size_t version;
+                const DoublyLinkedList* list;
+            public:
+                Finger() : node(nullptr), index(0), version(0), list(nullptr) {}
+                void reset() {
+                    node = nullptr;
                 }
-                return _marker->data;
-            }
+        };
+        Object& at(size_t index, Finger& finger) {
+            return fingerAt(index, finger)->data;
+        }
+        const Object& at(size_t index, Finger& finger) const {
+            return fingerAt(index, finger)->data;
         }
 
         void insert(size_t index, const Object& other)
@@ -140,132 +213,362 @@ class DoublyLinkedList {
             {
                 throw std::out_of_range("");
             }
-            // account for index == 0
+            Node* pos = (index == _size) ? nullptr : nodeAt(index, nullptr, 0);
+            linkBefore(pos, createNode(other));
+        }
+
+        void remove(size_t index)
+        {
+            if (_size == 0 || _head == nullptr)
+            {
+                throw std::out_of_range("");
+            } 
+            if (index >= _size)
+            {
+                throw std::out_of_range("");
+            }
+            Node* node = nodeAt(index, nullptr, 0);
+            unlink(node);
+            destroyNode(node);
+        }
+
+        bool empty() const {
+            return _size == 0;
+        }
+
+        iterator begin() {
+            return iterator(_head, this);
+        }
+        const_iterator begin() const {
+            return const_iterator(_head, this);
+        }
+        const_iterator cbegin() const {
+            return begin();
+        }
+        iterator end() {
+            return iterator(nullptr, this);
+        }
+        const_iterator end() const {
+            return const_iterator(nullptr, this);
+        }
+        const_iterator cend() const {
+            return end();
+        }
+
+        Object& front() {
             if (_head == nullptr)
             {
-                Node* newNode = new Node;
-                newNode->data = other;
-                newNode->prev = nullptr;
-                newNode->next = nullptr;
-                _head = newNode;
-                _tail = newNode;
-                _size++;
-                return;
+                throw std::out_of_range("");
             }
-            if (index == 0)
+            return _head->data;
+        }
+        const Object& front() const {
+            if (_head == nullptr)
             {
-                Node* newNode = new Node;
-                newNode->data = other;
-                newNode->prev = nullptr;
-                newNode->next = _head;
-                _head->prev = newNode;
-                _head = newNode;
-                _size++;
-                return;
+                throw std::out_of_range("");
             }
-            if (index == _size) // adding a tail
+            return _head->data;
+        }
+        Object& back() {
+            if (_tail == nullptr)
             {
-                _marker = _tail;
-                Node* newNode = new Node;
-                newNode->data = other;
-                newNode->prev = _marker;
-                newNode->next = nullptr;
-                _marker->next = newNode;
-                _tail = newNode;
-                _size++;
-                return;
+                throw std::out_of_range("");
             }
-            _marker = _head;
-            size_t i = 1;
-            while (i != index)
+            return _tail->data;
+        }
+        const Object& back() const {
+            if (_tail == nullptr)
             {
-                i++;
-                _marker = _marker->next;
+                throw std::out_of_range("");
             }
-            Node* newNode = new Node;
-            newNode->data = other;
-            newNode->next = _marker->next;
-            newNode->prev = _marker;
-            _marker->next->prev = newNode;
-            _marker->next = newNode;
-            _size++;
+            return _tail->data;
         }
 
-        void remove(size_t index)
-        {
-            if (_size == 0 || _head == nullptr)
+        // Builds the element in place before pos, O(1).
+        template <class... Args>
+        iterator emplace(const_iterator pos, Args&&... args) {
+            Node* newNode = createNode(std::forward<Args>(args)...);
+            linkBefore(pos.node, newNode);
+            return iterator(newNode, this);
+        }
+        iterator insert(const_iterator pos, const Object& other) {
+            return emplace(pos, other);
+        }
+        iterator insert(const_iterator pos, Object&& other) {
+            return emplace(pos, std::move(other));
+        }
+        template <class... Args>
+        Object& emplace_front(Args&&... args) {
+            return *emplace(begin(), std::forward<Args>(args)...);
+        }
+        template <class... Args>
+        Object& emplace_back(Args&&... args) {
+            return *emplace(end(), std::forward<Args>(args)...);
+        }
+        void push_front(const Object& other) {
+            emplace(begin(), other);
+        }
+        void push_front(Object&& other) {
+            emplace(begin(), std::move(other));
+        }
+        void push_back(const Object& other) {
+            emplace(end(), other);
+        }
+        void push_back(Object&& other) {
+            emplace(end(), std::move(other));
+        }
+
+        // Removes the element at pos and returns the one after it, O(1).
+        iterator erase(const_iterator pos) {
+            if (pos.node == nullptr)
             {
                 throw std::out_of_range("");
-            } 
-            if (index >= _size)
+            }
+            Node* next = pos.node->next;
+            unlink(pos.node);
+            destroyNode(pos.node);
+            return iterator(next, this);
+        }
+        iterator erase(const_iterator first, const_iterator last) {
+            while (first != last)
+            {
+                first = erase(first);
+            }
+            return iterator(last.node, this);
+        }
+        void pop_front() {
+            erase(begin());
+        }
+        void pop_back() {
+            if (_tail == nullptr)
             {
                 throw std::out_of_range("");
             }
-            _marker = _head;
-            if (index == 0 && _size == 1) // if the head is the only one
+            erase(const_iterator(_tail, this));
+        }
+
+        // Moves every node of other in front of pos without copying anything, O(1).
+        void splice(const_iterator pos, DoublyLinkedList& other) {
+            if (this == &other || other._head == nullptr)
             {
-                delete _head;
-                _head = nullptr;
-                _size--;
                 return;
             }
-            if (index == 0) // deleting head
+            checkSpliceAllocator(other);
+            Node* first = other._head;
+            Node* last = other._tail;
+            size_t count = other._size;
+            other._head = nullptr;
+            other._tail = nullptr;
+            other._size = 0;
+            linkRangeBefore(pos.node, first, last, count);
+        }
+        void splice(const_iterator pos, DoublyLinkedList&& other) {
+            splice(pos, other);
+        }
+        // Moves the single node at it from other in front of pos, O(1).
+        void splice(const_iterator pos, DoublyLinkedList& other, const_iterator it) {
+            if (it.node == nullptr)
             {
-                _marker = _marker->next;
-                _marker->prev = nullptr;
-                delete _head;
-                _head = _marker;
-                _size--;
-                return;
+                throw std::out_of_range("");
             }
-            if (index == _size - 1) // deleting tail
+            if (&other == this && (it.node == pos.node || it.node->next == pos.node))
+            {
+                return; // already in place
+            }
+            checkSpliceAllocator(other);
+            other.unlink(it.node);
+            linkBefore(pos.node, it.node);
+        }
+        // Moves [first, last) from other in front of pos. O(1) within one list,
+        // otherwise the range has to be walked once to keep both sizes right.
+        void splice(const_iterator pos, DoublyLinkedList& other, const_iterator first, const_iterator last) {
+            if (first == last)
             {
-                _marker = _tail->prev;
-                _marker->next = nullptr;
-                _tail->prev = nullptr;
-                delete _tail;
-                _tail = _marker;
-                _size--;
                 return;
             }
-            size_t i = 1;
-            _marker = _head->next;
-            while (i != index)
+            checkSpliceAllocator(other);
+            size_t count = 0;
+            if (this != &other)
             {
-                i++;
-                _marker = _marker->next;
-            }
-            _marker->prev->next = _marker->next;
-            _marker->next->prev = _marker->prev;
-            _marker->next = nullptr;
-            _marker->prev = nullptr;
-            delete _marker;
-            _size--;
-        }
-        void printList() {
-            _marker = _head;
-            if (_marker == nullptr) {
+                for (const_iterator it = first; it != last; ++it)
+                {
+                    count++;
+                }
+            }
+            Node* firstNode = first.node;
+            Node* lastNode = (last.node == nullptr) ? other._tail : last.node->prev;
+            other.unlinkRange(firstNode, lastNode, count);
+            linkRangeBefore(pos.node, firstNode, lastNode, count);
+        }
+
+        void printList() const {
+            const Node* marker = _head;
+            if (marker == nullptr) {
                 std::cout << "Linked list empty" << std::endl;
                 return;
             }
 
-            while (_marker != nullptr) {
-                std::cout << "[ " << _marker->data << " ]" << std::endl;
-                _marker = _marker->next;
+            while (marker != nullptr) {
+                std::cout << "[ " << marker->data << " ]" << std::endl;
+                marker = marker->next;
             }
         }
-        void printListRev() {
-            _marker = _tail;
-            if (_marker == nullptr) {
+        void printListRev() const {
+            const Node* marker = _tail;
+            if (marker == nullptr) {
                 std::cout << "Linked list empty" << std::endl;
                 return;
             }
 
-            while (_marker != nullptr) {
-                std::cout << "[ " << _marker->data << " ]" << std::endl;
-                _marker = _marker->prev;
+            while (marker != nullptr) {
+                std::cout << "[ " << marker->data << " ]" << std::endl;
+                marker = marker->prev;
+            }
+        }
+    private:
+        template <class... Args>
+        Node* createNode(Args&&... args) {
+            Node* node = NodeTraits::allocate(nodeAlloc, 1);
+            try
+            {
+                NodeTraits::construct(nodeAlloc, node, std::in_place, std::forward<Args>(args)...);
+            }
+            catch (...)
+            {
+                NodeTraits::deallocate(nodeAlloc, node, 1);
+                throw;
+            }
+            return node;
+        }
+        void destroyNode(Node* node) {
+            NodeTraits::destroy(nodeAlloc, node);
+            NodeTraits::deallocate(nodeAlloc, node, 1);
+        }
+        // pos == nullptr means the end of the list
+        void linkBefore(Node* pos, Node* node) {
+            linkRangeBefore(pos, node, node, 1);
+        }
+        void linkRangeBefore(Node* pos, Node* first, Node* last, size_t count) {
+            Node* before = (pos == nullptr) ? _tail : pos->prev;
+            first->prev = before;
+            last->next = pos;
+            if (before == nullptr)
+            {
+                _head = first;
+            }
+            else
+            {
+                before->next = first;
+            }
+            if (pos == nullptr)
+            {
+                _tail = last;
+            }
+            else
+            {
+                pos->prev = last;
+            }
+            _size += count;
+            _version++;
+        }
+        void unlink(Node* node) {
+            unlinkRange(node, node, 1);
+        }
+        void unlinkRange(Node* first, Node* last, size_t count) {
+            if (first->prev == nullptr)
+            {
+                _head = last->next;
+            }
+            else
+            {
+                first->prev->next = last->next;
+            }
+            if (last->next == nullptr)
+            {
+                _tail = first->prev;
+            }
+            else
+            {
+                last->next->prev = first->prev;
+            }
+            first->prev = nullptr;
+            last->next = nullptr;
+            _size -= count;
+            _version++;
+        }
+        // Finds node index starting from head, tail or hint (if given), whichever is closest.
+        Node* nodeAt(size_t index, Node* hint, size_t hintIndex) const {
+            if (index >= _size)
+            {
+                throw std::out_of_range("");
+            }
+            size_t fromTail = (_size - 1) - index;
+            Node* marker = _head;
+            size_t i = 0;
+            size_t best = index;
+            if (fromTail < best) {
+                marker = _tail;
+                i = _size - 1;
+                best = fromTail;
+            }
+            if (hint != nullptr) {
+                size_t fromHint = (hintIndex > index) ? hintIndex - index : index - hintIndex;
+                if (fromHint < best) {
+                    marker = hint;
+                    i = hintIndex;
+                }
+            }
+            while (i < index) {
+                i++;
+                marker = marker->next;
+            }
+            while (i > index) {
+                i--;
+                marker = marker->prev;
+            }
+            return marker;
+        }
+        Node* fingerAt(size_t index, Finger& finger) const {
+            Node* hint = nullptr;
+            if (finger.list == this && finger.version == _version)
+            {
+                hint = finger.node;
+            }
+            Node* node = nodeAt(index, hint, finger.index);
+            finger.node = node;
+            finger.index = index;
+            finger.version = _version;
+            finger.list = this;
+            return node;
+        }
+        // Adopts every node of other, which is left empty. Both lists have to be able to free
+        // each other's nodes, and this one has to be empty.
+        void takeNodes(DoublyLinkedList& other) {
+            _head = other._head;
+            _tail = other._tail;
+            _size = other._size;
+            _version++;
+            other._head = nullptr;
+            other._tail = nullptr;
+            other._size = 0;
+            other._version++;
+        }
+        void moveElementsFrom(DoublyLinkedList& other) {
+            for (Node* node = other._head; node != nullptr; node = node->next)
+            {
+                linkBefore(nullptr, createNode(std::move(node->data)));
+            }
+            other.clear();
+        }
+        void checkSpliceAllocator(const DoublyLinkedList& other) const {
+            if (nodeAlloc != other.nodeAlloc)
+            {
+                throw std::invalid_argument("splice between lists with unequal allocators");
             }
         }
 };
 
+template <typename Object>
+using PmrDoublyLinkedList = DoublyLinkedList<Object, std::pmr::polymorphic_allocator<Object>>;
+
 #endif  // DOUBLY_LINKED_LIST_H
@@ -0,0 +1,249 @@
+#ifndef EPOCH_RECLAMATION_H
+#define EPOCH_RECLAMATION_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// Process wide epoch based reclamation for structures whose readers walk several nodes
+// in a row, where one hazard pointer per thread is not enough. A reader pins the current
+// epoch for the duration of an operation (Guard), and unlinked nodes are handed to
+// retire() tagged with the epoch they were retired in. The global epoch only moves on
+// once every pinned thread has caught up with it, so two epochs later no reader can
+// still be holding a node retired in the first one and it is freed.
+// Reads are a couple of thread local stores, at the price of a stalled reader holding
+// back every retired node until it unpins.
+class EpochReclamation {
+    private:
+        static constexpr size_t ScanThreshold = 64;
+        static constexpr size_t RetiredCapacity = 4 * ScanThreshold;
+        static constexpr uint64_t Quiescent = 0; // epochs start at 1
+
+        struct Record {
+            std::atomic<uint64_t> epoch; // pinned epoch, or Quiescent
+            std::atomic<bool> active;
+            Record* next;
+        };
+        struct Retired {
+            void* pointer;
+            void (*deleter)(void*);
+            uint64_t epoch;
+        };
+        // Trivially destructible so it stays usable while other thread locals are torn down.
+        struct ThreadState {
+            Record* record;
+            size_t nesting;
+            Retired retired[RetiredCapacity];
+            size_t count;
+            bool registered;
+            bool closed;
+        };
+        struct ThreadFlusher {
+            ~ThreadFlusher()
+            {
+                ThreadState& s = state;
+                tryAdvance();
+                s.count = collect(s.retired, s.count);
+                orphan(s.retired, s.count);
+                s.count = 0;
+                if (s.record != nullptr)
+                {
+                    s.record->epoch.store(Quiescent, std::memory_order_release);
+                    s.record->active.store(false, std::memory_order_release);
+                    s.record = nullptr;
+                }
+                s.closed = true;
+            }
+        };
+        static inline std::atomic<uint64_t> globalEpoch{1};
+        static inline std::atomic<Record*> records{nullptr};
+        static inline thread_local ThreadState state{};
+        static inline thread_local ThreadFlusher flusher;
+
+    public:
+        // Pins the epoch for its lifetime; nodes reached inside stay valid until it ends.
+        class Guard {
+            public:
+                Guard() {
+                    enter();
+                }
+                ~Guard() {
+                    leave();
+                }
+                Guard(const Guard& other) = delete;
+                Guard& operator=(const Guard& other) = delete;
+        };
+
+        // Guards nest, only the outermost one pins.
+        static void enter()
+        {
+            ThreadState& s = state;
+            if (s.nesting++ > 0)
+            {
+                return;
+            }
+            Record* r = record();
+            r->epoch.store(globalEpoch.load(std::memory_order_relaxed), std::memory_order_seq_cst);
+            // pairs with the fence in tryAdvance: either the advancing thread sees this pin,
+            // or this thread sees every unlink that happened before the advance
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+        }
+        static void leave()
+        {
+            ThreadState& s = state;
+            if (--s.nesting == 0)
+            {
+                s.record->epoch.store(Quiescent, std::memory_order_release);
+            }
+        }
+
+        // Frees p with deleter once no pinned thread can still reach it. p must already be
+        // unreachable for threads that pin from now on.
+        static void retire(void* p, void (*deleter)(void*))
+        {
+            ThreadState& s = state;
+            uint64_t epoch = globalEpoch.load(std::memory_order_seq_cst);
+            if (s.closed)
+            {
+                // thread is exiting, let whoever collects next take care of it
+                Retired late[1] = {{p, deleter, epoch}};
+                orphan(late, 1);
+                return;
+            }
+            s.retired[s.count++] = Retired{p, deleter, epoch};
+            if (s.count >= ScanThreshold)
+            {
+                tryAdvance();
+                s.count = collect(s.retired, s.count);
+                if (s.count == RetiredCapacity)
+                {
+                    // some reader is holding the epoch back, park them globally
+                    orphan(s.retired, s.count);
+                    s.count = 0;
+                }
+            }
+        }
+
+    private:
+        static Record* record()
+        {
+            ThreadState& s = state;
+            if (s.record == nullptr)
+            {
+                if (!s.registered && !s.closed)
+                {
+                    s.registered = true;
+                    (void) &flusher; // first use sets up the release at thread exit
+                }
+                // a thread that is already exiting keeps its record for good
+                s.record = acquireRecord();
+            }
+            return s.record;
+        }
+
+        static Record* acquireRecord()
+        {
+            for (Record* r = records.load(std::memory_order_acquire); r != nullptr; r = r->next)
+            {
+                bool expected = false;
+                if (!r->active.load(std::memory_order_relaxed)
+                    && r->active.compare_exchange_strong(expected, true, std::memory_order_acquire))
+                {
+                    return r;
+                }
+            }
+            // records are never freed, other threads may be scanning them at any time
+            Record* r = new Record;
+            r->epoch.store(Quiescent, std::memory_order_relaxed);
+            r->active.store(true, std::memory_order_relaxed);
+            r->next = records.load(std::memory_order_relaxed);
+            while (!records.compare_exchange_weak(r->next, r, std::memory_order_release, std::memory_order_relaxed))
+            {
+            }
+            return r;
+        }
+
+        // Moves the global epoch on by one if every pinned thread is in the current one.
+        static void tryAdvance()
+        {
+            uint64_t current = globalEpoch.load(std::memory_order_seq_cst);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            for (Record* r = records.load(std::memory_order_acquire); r != nullptr; r = r->next)
+            {
+                uint64_t pinned = r->epoch.load(std::memory_order_seq_cst);
+                if (pinned != Quiescent && pinned != current)
+                {
+                    return;
+                }
+            }
+            globalEpoch.compare_exchange_strong(current, current + 1, std::memory_order_seq_cst);
+        }
+
+        // Frees every entry of list retired at least two epochs ago, compacts the rest to
+        // the front and returns how many are left.
+        static size_t collect(Retired* list, size_t count)
+        {
+            uint64_t current = globalEpoch.load(std::memory_order_seq_cst);
+            size_t kept = 0;
+            for (size_t i = 0; i < count; i++)
+            {
+                if (list[i].epoch + 2 <= current)
+                {
+                    list[i].deleter(list[i].pointer);
+                }
+                else
+                {
+                    list[kept++] = list[i];
+                }
+            }
+            reclaimOrphans(current);
+            return kept;
+        }
+
+        // Nodes left behind by exited threads; never destroyed so exit order does not matter.
+        static std::mutex& orphanLock()
+        {
+            static std::mutex* lock = new std::mutex;
+            return *lock;
+        }
+        static std::vector<Retired>& orphans()
+        {
+            static std::vector<Retired>* list = new std::vector<Retired>;
+            return *list;
+        }
+        static void orphan(const Retired* list, size_t count)
+        {
+            if (count == 0)
+            {
+                return;
+            }
+            std::lock_guard<std::mutex> guard(orphanLock());
+            orphans().insert(orphans().end(), list, list + count);
+        }
+        static void reclaimOrphans(uint64_t current)
+        {
+            std::unique_lock<std::mutex> guard(orphanLock(), std::try_to_lock);
+            if (!guard.owns_lock())
+            {
+                return;
+            }
+            std::vector<Retired>& list = orphans();
+            size_t kept = 0;
+            for (size_t i = 0; i < list.size(); i++)
+            {
+                if (list[i].epoch + 2 <= current)
+                {
+                    list[i].deleter(list[i].pointer);
+                }
+                else
+                {
+                    list[kept++] = list[i];
+                }
+            }
+            list.resize(kept);
+        }
+};
+
+#endif  // EPOCH_RECLAMATION_H
@@ -5,6 +5,7 @@
 #include <cmath> 
 #include <cstddef> 
 #include <iostream> 
+#include "indexed_priority_queue.h"
 #include <list> 
 #include <vector>
 #include <unordered_map>
@@ -22,8 +23,9 @@ class Graph {
         struct Vertex {
             vector<Edge> adjList;
             double distance = INFINITY;
-            bool known;
+            bool known = false;
             size_t nextNode = INT32_MAX;
+            size_t queueHandle = 0; // only meaningful while dijkstra has the vertex queued
         };
         unordered_map <size_t,Vertex> vertexList;
         size_t numEdges; // total number of elements in the list
@@ -198,37 +200,57 @@ class Graph {
             return minID;
         }
         
+        // O((V + E) log V): every unknown vertex with a finite distance sits in the queue,
+        // and finding a shorter path to it lowers its key in place.
         void dijkstra(size_t source_id) {
-            int numUnknown = 0;
-            for (auto& pair : vertexList) // rethink how distance works...?
+            for (auto& pair : vertexList)
             {
                 pair.second.distance = INFINITY;
                 pair.second.known = false;
                 pair.second.nextNode = INT32_MAX;
-                numUnknown++;
             }
             if (!contains_vertex(source_id))
             {
                 return;
             }
-            vertexList.find(source_id)->second.distance = 0;
-            while (numUnknown > 0) // use a counter for num unknown
+            IndexedPriorityQueue<double> queue;
+            vector<size_t> handleVertex; // queue handle -> vertex id
+            auto enqueue = [&](Vertex& vertex, size_t id) {
+                vertex.queueHandle = queue.push(vertex.distance);
+                if (vertex.queueHandle >= handleVertex.size())
+                {
+                    handleVertex.resize(vertex.queueHandle + 1);
+                }
+                handleVertex[vertex.queueHandle] = id;
+            };
+            Vertex& source = vertexList.find(source_id)->second;
+            source.distance = 0;
+            enqueue(source, source_id);
+            while (!queue.empty())
             {
-                size_t smallestUnknownID = minDistance();
-                unordered_map <size_t,Vertex>::iterator itr = vertexList.find(smallestUnknownID);
-                itr->second.known = true;
-                numUnknown--;
-                for (vector<Edge>::iterator vectorItr = itr->second.adjList.begin(); vectorItr != itr->second.adjList.end(); vectorItr++)
+                size_t smallestUnknownID = handleVertex[queue.top_handle()];
+                queue.pop();
+                Vertex& v = vertexList.find(smallestUnknownID)->second;
+                v.known = true;
+                for (const Edge& edge : v.adjList)
                 {
-                    if (!vertexList.find(vectorItr->id)->second.known) // the vertex w is unknown
+                    Vertex& w = vertexList.find(edge.id)->second;
+                    if (w.known)
+                    {
+                        continue;
+                    }
+                    if (v.distance + edge._weight < w.distance) // v.dist + cvw < w.dist
                     {
-                        double cvw = cost(smallestUnknownID,vectorItr->id);
-                        double vDist = vertexList.find(smallestUnknownID)->second.distance;
-                        double wDist = vertexList.find(vectorItr->id)->second.distance;
-                        if (vDist + cvw < wDist) // v.dist + cvw < w.dist
+                        bool queued = w.distance != INFINITY;
+                        w.distance = v.distance + edge._weight;
+                        w.nextNode = smallestUnknownID;
+                        if (queued)
+                        {
+                            queue.decrease_key(w.queueHandle, w.distance);
+                        }
+                        else
                         {
-                            vertexList.find(vectorItr->id)->second.distance = vDist + cvw;
-                            vertexList.find(vectorItr->id)->second.nextNode = smallestUnknownID;
+                            enqueue(w, edge.id);
                         }
                     }
                 }
@@ -2,41 +2,95 @@
 #define HASHTABLE_OPEN_ADDRESSING_H
 
 #include <iostream>
+#include <memory>
+#include <memory_resource>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 #include <vector>
 #include <list>
+#include "transparent_hash.h"
 
 using std::vector, std::list, std::cout, std::endl;
 
-template <class Key, class Hash=std::hash<Key>>
-class HashTable {
+// What the table stores for a set: the key itself.
+template <class Key>
+struct HashSetElement {
+    using type = Key;
+    static const Key& key(const type& element) {
+        return element;
+    }
+    static void print(std::ostream& os, const type& element) {
+        os << element;
+    }
+};
+
+// What the table stores for a map: the key next to its value.
+template <class Key, class Value>
+struct HashMapElement {
+    using type = std::pair<Key, Value>;
+    static const Key& key(const type& element) {
+        return element.first;
+    }
+    static void print(std::ostream& os, const type& element) {
+        os << element.first << " -> " << element.second;
+    }
+};
+
+// Linear probing engine shared by HashTable and HashMap. ElementPolicy says what a slot
+// holds and how to get the key out of it.
+// Insertion is Robin Hood style: every slot remembers how far it sits from its home slot,
+// and a new element takes over the slot of any element closer to home than itself,
+// which then moves on. That keeps probe lengths even, and lets a lookup stop as soon as
+// it meets an element closer to home than the key would be, so a single probe finds
+// either the key or the slot a new one goes to. Removal shifts the following elements
+// back one slot instead of leaving a DELETED marker, so no tombstones pile up.
+// With a nonzero rehash_step a resize is spread out: the old table stays around and each
+// insert or remove moves rehash_step of its slots over, while lookups check both tables.
+template <class Key, class ElementPolicy, class Hash, class KeyEqual, class Allocator>
+class HashTableBase {
+    protected:
+        using Element = typename ElementPolicy::type;
+        template <class K>
+        using EnableTransparent = std::enable_if_t<IsTransparentLookup<Hash, KeyEqual>::value, K>;
+
     public:
-        enum EntryType { ACTIVE, EMPTY, DELETED };
+        enum EntryType { ACTIVE, EMPTY, DELETED }; // DELETED only marks slots of a table being migrated
+        using allocator_type = Allocator;
 
-        HashTable<Key,Hash>() : table(11), totalElements(0) {}
-        explicit HashTable(size_t capacity) : table(capacity), totalElements(0) {}
-        HashTable(const HashTable& other) : table(other.table.capacity()), totalElements(other.totalElements) {
-            for (size_t i = 0; i < other.table.size(); i++)
-            {
-                table.at(i) = other.table.at(i);
-            }
-        }
-        HashTable& operator=(const HashTable& other) {
+        HashTableBase() : table(11), totalElements(0), oldTable(), migrated(0), oldElements(0), migrationStep(0) {}
+        explicit HashTableBase(const Allocator& alloc)
+            : table(11, EntryAllocator(alloc)), totalElements(0), oldTable(EntryAllocator(alloc)), migrated(0), oldElements(0), migrationStep(0) {}
+        explicit HashTableBase(size_t capacity, const Allocator& alloc = Allocator())
+            : table(capacity == 0 ? 1 : capacity, EntryAllocator(alloc)), totalElements(0), oldTable(EntryAllocator(alloc)),
+              migrated(0), oldElements(0), migrationStep(0) {}
+        HashTableBase(const HashTableBase& other)
+            : table(other.table, std::allocator_traits<EntryAllocator>::select_on_container_copy_construction(other.table.get_allocator())),
+              totalElements(other.totalElements), oldTable(other.oldTable, table.get_allocator()), migrated(other.migrated),
+              oldElements(other.oldElements), migrationStep(other.migrationStep) {}
+        HashTableBase& operator=(const HashTableBase& other) {
             if (this == &other)
             {
                 return *this;
             }
-            vector<HashEntry> newTable (other.table.capacity());
-            for (size_t i = 0; i < other.table.size(); i++)
-            {
-                newTable.at(i) = other.table.at(i);
-            }
+            EntryTable newTable (other.table, table.get_allocator());
+            EntryTable newOldTable (other.oldTable, table.get_allocator());
             table.swap(newTable);
+            oldTable.swap(newOldTable);
             totalElements = other.totalElements;
+            migrated = other.migrated;
+            oldElements = other.oldElements;
+            migrationStep = other.migrationStep;
             return *this;
         }
-        ~HashTable() {
+        ~HashTableBase() {
             totalElements = 0;
             table.clear(); // clears the vector
+            oldTable.clear();
+        }
+        Allocator get_allocator() const {
+            return Allocator(table.get_allocator());
         }
         bool is_empty() const {
             if (table.empty() || totalElements == 0)
@@ -47,7 +101,7 @@ class HashTable {
             return totalElements;
         }
         size_t table_size() const {
-            return table.capacity();
+            return table.size();
         }
         void make_empty() {
             totalElements = 0;
@@ -55,94 +109,82 @@ class HashTable {
             {
                 table.at(i).info = EMPTY;
             }
+            endMigration();
         }
 
-        bool isActive(int currentPos) const
-        { 
+        bool isActive(size_t currentPos) const
+        {
             return table[currentPos].info == ACTIVE;
         }
 
         bool contains(const Key& x) const
-        { 
-            return isActive(position(x));
+        {
+            return findElement(x) != nullptr;
         }
-
-        size_t position(const Key& x) const
+        template <class K, class = EnableTransparent<K>>
+        bool contains(const K& x) const
         {
-            size_t currentPos = Hash {} (x) % table.capacity();
-            //cout << "currentPos after hashing: " << currentPos << endl;
-            while(table[currentPos].info != EMPTY && table[currentPos].element != x)
-            {
-                currentPos += 1;
-                {
-                    if (currentPos >= table.capacity())
-                        currentPos = 0;
-                }
-            }
-            return currentPos;
+            return findElement(x) != nullptr;
         }
 
-        bool insert(const Key& x)
+        // Slot of the current table holding x, or the slot x would be inserted at.
+        template <class K>
+        size_t position(const K& x) const
         {
-            if (contains(x))
-            {
-                return false;
-            }
-            size_t currentPos = position(x);
-            if(isActive(currentPos))
-                return false;
-            HashEntry toInsert;
-            toInsert.element = x;
-            toInsert.info = ACTIVE;
-            table[currentPos] = toInsert;
-            totalElements++;
-
-            if(((float) totalElements / table.capacity()) > 0.5)
-            {
-                rehash();
-            }
-
-            return true;
+            return probe(table, x, Hash {} (x)).pos;
         }
 
         size_t remove(const Key& x)
         {
-            if (!contains(x))
-            {
-                return 0;
-            }
-            size_t currentPos = position(x);
-            if(!isActive(currentPos))
-                return 0;
-
-            table[currentPos].info = DELETED;
-            totalElements--;
-            return 1;
+            return removeKey(x);
         }
-
-        void rehash() 
+        template <class K, class = EnableTransparent<K>>
+        size_t remove(const K& x)
         {
-            vector<HashEntry> oldArray = table;
+            return removeKey(x);
+        }
 
-            table.resize(getNextPrime(2 * oldArray.size()));
-            for( HashEntry& entry : table )
-                entry.info = EMPTY;
+        // Grows the table in one go.
+        void rehash()
+        {
+            finish_migration();
+            EntryTable oldArray (getNextPrime(2 * table.size()), table.get_allocator());
+            oldArray.swap(table);
 
-            totalElements = 0;
             for(HashEntry& entry : oldArray)
                 if( entry.info == ACTIVE )
-                    insert(std::move(entry.element));
+                    place(home(table, ElementPolicy::key(entry.element)), 0, std::move(entry.element)); // keys are distinct, no lookup needed
+        }
+
+        // Old table slots moved per insert or remove while a resize is in progress;
+        // 0 (the default) resizes all at once.
+        size_t rehash_step() const {
+            return migrationStep;
+        }
+        void rehash_step(size_t step) {
+            migrationStep = step;
+            if (step == 0)
+            {
+                finish_migration();
+            }
+        }
+        // Old table slots still to be moved, 0 when no resize is in progress.
+        size_t pending_migration() const {
+            return migrating() ? oldTable.size() - migrated : 0;
+        }
+        void finish_migration() {
+            migrate(oldTable.size());
         }
 
         bool isPrime(size_t n)
         {
-            if (n <= 1)  
+            if (n <= 1)
                 return false;
-            if (n <= 3)  
+            if (n <= 3)
                 return true;
-            if (n % 2 == 0 || n % 3 == 0) 
+            if (n % 2 == 0 || n % 3 == 0)
                 return false;
-        
+
             for (size_t i = 5; i * i <= n; i+=6)
             {
                 if (n % i == 0 || n % (i + 2) == 0)
@@ -173,25 +215,379 @@ class HashTable {
                 os << "<empty>\n";
                 return;
             }
-            int index = 0;
-            for (HashEntry entry : table)
+            printEntries(os, table, "");
+            printEntries(os, oldTable, "old ");
+        }
+
+    protected:
+        template <class K>
+        Element* findElement(const K& x)
+        {
+            return const_cast<Element*>(static_cast<const HashTableBase&>(*this).findElement(x));
+        }
+        template <class K>
+        const Element* findElement(const K& x) const
+        {
+            size_t hash = Hash {} (x);
+            Probe found = probe(table, x, hash);
+            if (found.found)
             {
-                if (entry.info == ACTIVE)
+                return &table[found.pos].element;
+            }
+            if (migrating())
+            {
+                found = probe(oldTable, x, hash);
+                if (found.found)
                 {
-                    os << index << ": " << entry.element << "\n";
+                    return &oldTable[found.pos].element;
+                }
+            }
+            return nullptr;
+        }
+
+        // Builds the element from args only when key is not in the table yet. The table
+        // grows before the element goes in; the returned pointer stays valid until the
+        // next insertion or removal.
+        template <class K, class... Args>
+        std::pair<Element*, bool> emplaceUnique(const K& key, Args&&... args)
+        {
+            migrate(migrationStep);
+            size_t hash = Hash {} (key);
+            Probe found = probe(table, key, hash);
+            if (found.found)
+            {
+                return {&table[found.pos].element, false};
+            }
+            if (migrating())
+            {
+                Probe old = probe(oldTable, key, hash);
+                if (old.found)
+                {
+                    return {&oldTable[old.pos].element, false};
                 }
-                index++;
             }
+            if (((float) (totalElements + 1) / table.size()) > 0.5)
+            {
+                grow();
+                found = probe(table, key, hash); // where key goes in the new table
+            }
+            place(found.pos, found.distance, Element(std::forward<Args>(args)...));
+            totalElements++;
+            return {&table[found.pos].element, true};
         }
 
-    private: 
+    private:
         struct HashEntry
         {
-            Key element;
+            Element element;
             EntryType info = EMPTY;
+            size_t distance = 0; // slots away from the home slot of element
         };
-        vector<HashEntry> table;
+        struct Probe
+        {
+            size_t pos;
+            size_t distance;
+            bool found;
+        };
+        using EntryAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<HashEntry>;
+        using EntryTable = vector<HashEntry, EntryAllocator>;
+
+        EntryTable table;
         size_t totalElements;
+        EntryTable oldTable; // empty unless a resize is in progress
+        size_t migrated; // old table slots below this one have been moved
+        size_t oldElements;
+        size_t migrationStep;
+
+        template <class K>
+        static size_t home(const EntryTable& slots, const K& x)
+        {
+            return Hash {} (x) % slots.size();
+        }
+        static size_t next(const EntryTable& slots, size_t currentPos)
+        {
+            currentPos += 1;
+            return currentPos >= slots.size() ? 0 : currentPos;
+        }
+
+        // Walks from the home slot until it finds x, an EMPTY slot, or an element closer to
+        // its own home than x would be at that slot; x cannot be past that point.
+        // DELETED slots keep their distance, so the old table can still be searched while
+        // elements leave it.
+        template <class K>
+        static Probe probe(const EntryTable& slots, const K& x, size_t hash)
+        {
+            size_t currentPos = hash % slots.size();
+            size_t distance = 0;
+            while (true)
+            {
+                const HashEntry& entry = slots[currentPos];
+                if (entry.info == EMPTY || entry.distance < distance)
+                {
+                    return {currentPos, distance, false};
+                }
+                // an equal key has the same home, so only elements at the same distance can match
+                if (entry.info == ACTIVE && entry.distance == distance && KeyEqual {} (ElementPolicy::key(entry.element), x))
+                {
+                    return {currentPos, distance, true};
+                }
+                currentPos = next(slots, currentPos);
+                distance++;
+            }
+        }
+
+        // Puts element at currentPos of the current table, distance slots from its home,
+        // and carries whatever was there further along until something lands in an empty slot.
+        void place(size_t currentPos, size_t distance, Element&& element)
+        {
+            Element carried = std::move(element);
+            while (true)
+            {
+                HashEntry& entry = table[currentPos];
+                if (entry.info != ACTIVE)
+                {
+                    entry.element = std::move(carried);
+                    entry.info = ACTIVE;
+                    entry.distance = distance;
+                    break;
+                }
+                if (entry.distance < distance)
+                {
+                    std::swap(entry.element, carried);
+                    std::swap(entry.distance, distance);
+                }
+                currentPos = next(table, currentPos);
+                distance++;
+            }
+        }
+
+        template <class K>
+        size_t removeKey(const K& x)
+        {
+            migrate(migrationStep);
+            size_t hash = Hash {} (x);
+            Probe found = probe(table, x, hash);
+            if (!found.found)
+            {
+                if (!migrating())
+                    return 0;
+                found = probe(oldTable, x, hash);
+                if (!found.found)
+                    return 0;
+                // slots of the old table are only ever marked, nothing moves there
+                oldTable[found.pos].element = Element();
+                oldTable[found.pos].info = DELETED;
+                oldElements--;
+                totalElements--;
+                return 1;
+            }
+
+            // shift the rest of the cluster back a slot until an element already at home
+            size_t currentPos = found.pos;
+            size_t following = next(table, currentPos);
+            while (table[following].info == ACTIVE && table[following].distance > 0)
+            {
+                table[currentPos].element = std::move(table[following].element);
+                table[currentPos].distance = table[following].distance - 1;
+                currentPos = following;
+                following = next(table, following);
+            }
+            table[currentPos].element = Element(); // let go of what the slot held
+            table[currentPos].info = EMPTY;
+            table[currentPos].distance = 0;
+            totalElements--;
+            return 1;
+        }
+
+        bool migrating() const
+        {
+            return !oldTable.empty();
+        }
+        void grow()
+        {
+            if (migrationStep == 0)
+            {
+                rehash();
+                return;
+            }
+            finish_migration(); // only one resize in flight at a time
+            EntryTable bigger (getNextPrime(2 * table.size()), table.get_allocator());
+            oldTable.swap(table);
+            table.swap(bigger);
+            migrated = 0;
+            oldElements = totalElements;
+        }
+        // Moves up to slots old table slots into the current table.
+        void migrate(size_t slots)
+        {
+            if (!migrating())
+                return;
+            size_t end = oldTable.size() - migrated < slots ? oldTable.size() : migrated + slots;
+            for (; migrated < end && oldElements > 0; migrated++)
+            {
+                HashEntry& entry = oldTable[migrated];
+                if (entry.info == ACTIVE)
+                {
+                    place(home(table, ElementPolicy::key(entry.element)), 0, std::move(entry.element));
+                    entry.element = Element();
+                    entry.info = DELETED;
+                    oldElements--;
+                }
+            }
+            if (migrated == oldTable.size() || oldElements == 0)
+            {
+                endMigration();
+            }
+        }
+        void endMigration()
+        {
+            EntryTable released (table.get_allocator());
+            oldTable.swap(released);
+            migrated = 0;
+            oldElements = 0;
+        }
+
+        void printEntries(std::ostream& os, const EntryTable& slots, const char* label) const
+        {
+            int index = 0;
+            for (const HashEntry& entry : slots)
+            {
+                if (entry.info == ACTIVE)
+                {
+                    os << label << index << ": ";
+                    ElementPolicy::print(os, entry.element);
+                    os << "\n";
+                }
+                index++;
+            }
+        }
 };
 
+template <class Key, class Hash=std::hash<Key>, class KeyEqual=std::equal_to<Key>, class Allocator=std::allocator<Key>>
+class HashTable : public HashTableBase<Key, HashSetElement<Key>, Hash, KeyEqual, Allocator> {
+    using Base = HashTableBase<Key, HashSetElement<Key>, Hash, KeyEqual, Allocator>;
+    public:
+        using Base::Base;
+
+        bool insert(const Key& x)
+        {
+            return this->emplaceUnique(x, x).second;
+        }
+        bool insert(Key&& x)
+        {
+            return this->emplaceUnique(x, std::move(x)).second;
+        }
+};
+
+// Key to value map on the same engine. find hands back a pointer to the value, or
+// nullptr, so one probe serves both the lookup and an update through the pointer.
+template <class Key, class Value, class Hash=std::hash<Key>, class KeyEqual=std::equal_to<Key>,
+          class Allocator=std::allocator<std::pair<const Key, Value>>>
+class HashMap : public HashTableBase<Key, HashMapElement<Key, Value>, Hash, KeyEqual, Allocator> {
+    using Base = HashTableBase<Key, HashMapElement<Key, Value>, Hash, KeyEqual, Allocator>;
+    template <class K>
+    using EnableTransparent = typename Base::template EnableTransparent<K>;
+
+    public:
+        using Base::Base;
+
+        Value* find(const Key& key)
+        {
+            return valueOf(this->findElement(key));
+        }
+        const Value* find(const Key& key) const
+        {
+            return valueOf(this->findElement(key));
+        }
+        template <class K, class = EnableTransparent<K>>
+        Value* find(const K& key)
+        {
+            return valueOf(this->findElement(key));
+        }
+        template <class K, class = EnableTransparent<K>>
+        const Value* find(const K& key) const
+        {
+            return valueOf(this->findElement(key));
+        }
+
+        Value& at(const Key& key)
+        {
+            Value* value = find(key);
+            if (value == nullptr)
+            {
+                throw std::out_of_range("");
+            }
+            return *value;
+        }
+        const Value& at(const Key& key) const
+        {
+            const Value* value = find(key);
+            if (value == nullptr)
+            {
+                throw std::out_of_range("");
+            }
+            return *value;
+        }
+
+        Value& operator[](const Key& key)
+        {
+            return *try_emplace(key).first;
+        }
+        Value& operator[](Key&& key)
+        {
+            return *try_emplace(std::move(key)).first;
+        }
+
+        // Leaves an existing value alone; args are only used when the key is new.
+        template <class... Args>
+        std::pair<Value*, bool> try_emplace(const Key& key, Args&&... args)
+        {
+            auto result = this->emplaceUnique(key, std::piecewise_construct, std::forward_as_tuple(key),
+                                              std::forward_as_tuple(std::forward<Args>(args)...));
+            return {&result.first->second, result.second};
+        }
+        template <class... Args>
+        std::pair<Value*, bool> try_emplace(Key&& key, Args&&... args)
+        {
+            auto result = this->emplaceUnique(key, std::piecewise_construct, std::forward_as_tuple(std::move(key)),
+                                              std::forward_as_tuple(std::forward<Args>(args)...));
+            return {&result.first->second, result.second};
+        }
+
+        // Returns true when the key was new, false when an existing value was replaced.
+        template <class V>
+        std::pair<Value*, bool> insert_or_assign(const Key& key, V&& value)
+        {
+            std::pair<Value*, bool> result = try_emplace(key, std::forward<V>(value));
+            if (!result.second)
+            {
+                *result.first = std::forward<V>(value);
+            }
+            return result;
+        }
+        template <class V>
+        std::pair<Value*, bool> insert_or_assign(Key&& key, V&& value)
+        {
+            std::pair<Value*, bool> result = try_emplace(std::move(key), std::forward<V>(value));
+            if (!result.second)
+            {
+                *result.first = std::forward<V>(value);
+            }
+            return result;
+        }
+
+    private:
+        template <class E>
+        static auto valueOf(E* element) -> decltype(&element->second)
+        {
+            return element == nullptr ? nullptr : &element->second;
+        }
+};
+
+template <class Key, class Hash=std::hash<Key>, class KeyEqual=std::equal_to<Key>>
+using PmrHashTable = HashTable<Key, Hash, KeyEqual, std::pmr::polymorphic_allocator<Key>>;
+
+template <class Key, class Value, class Hash=std::hash<Key>, class KeyEqual=std::equal_to<Key>>
+using PmrHashMap = HashMap<Key, Value, Hash, KeyEqual, std::pmr::polymorphic_allocator<std::pair<const Key, Value>>>;
+
 #endif  // HASHTABLE_OPEN_ADDRESSING_H
\ No newline at end of file
@@ -2,47 +2,106 @@
 #define HASHTABLE_SEPARATE_CHAINING_H
 
 #include <iostream>
+#include <memory>
+#include <memory_resource>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 #include <vector>
 #include <list>
+#include "transparent_hash.h"
 
 using std::vector, std::list, std::cout, std::endl;
 
-template <class Key, class Hash=std::hash<Key>>
-class HashTable {
-    private: 
-        vector<list<Key>> table;
+// What a bucket stores for a set: the key itself.
+template <class Key>
+struct HashSetElement {
+    using type = Key;
+    static const Key& key(const type& element) {
+        return element;
+    }
+    static void print(std::ostream& os, const type& element) {
+        os << element;
+    }
+};
+
+// What a bucket stores for a map: the key next to its value.
+template <class Key, class Value>
+struct HashMapElement {
+    using type = std::pair<const Key, Value>;
+    static const Key& key(const type& element) {
+        return element.first;
+    }
+    static void print(std::ostream& os, const type& element) {
+        os << element.first << " -> " << element.second;
+    }
+};
+
+// Separate chaining engine shared by HashTable and HashMap. ElementPolicy says what a
+// bucket holds and how to get the key out of it. Elements live in list nodes that never
+// move, so pointers handed out by HashMap stay valid until the element is removed.
+// With a nonzero rehash_step a resize is spread out: the old bucket array stays around
+// and each insert or remove splices rehash_step of its buckets over, while lookups check
+// both arrays.
+template <class Key, class ElementPolicy, class Hash, class KeyEqual, class Allocator>
+class HashTableBase {
+    protected:
+        using Element = typename ElementPolicy::type;
+        template <class K>
+        using EnableTransparent = std::enable_if_t<IsTransparentLookup<Hash, KeyEqual>::value, K>;
+
+    private:
+        using ElementAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Element>;
+        using Bucket = list<Element, ElementAllocator>;
+        using BucketAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Bucket>;
+        using BucketTable = vector<Bucket, BucketAllocator>;
+
+        BucketTable table;
         size_t totalElements;
         float maxLoad;
+        BucketTable oldTable; // empty unless a resize is in progress
+        size_t migrated; // old buckets below this one have been moved
+        size_t migrationStep;
     public:
-        HashTable<Key,Hash>() : table(11), totalElements(0), maxLoad(1) {}
-        explicit HashTable(size_t capacity) : table(capacity), totalElements(0), maxLoad(1) {}
-        HashTable(const HashTable& other) : table(other.table.capacity()), totalElements(other.totalElements), maxLoad(other.maxLoad) {
-            for (size_t i = 0; i < other.table.size(); i++)
-            {
-                table.at(i) = other.table.at(i);
-            }
-        }
-        HashTable& operator=(const HashTable& other) {
+        using allocator_type = Allocator;
+
+        HashTableBase() : table(11), totalElements(0), maxLoad(1), oldTable(), migrated(0), migrationStep(0) {}
+        explicit HashTableBase(const Allocator& alloc)
+            : table(11, BucketAllocator(alloc)), totalElements(0), maxLoad(1), oldTable(BucketAllocator(alloc)), migrated(0), migrationStep(0) {}
+        explicit HashTableBase(size_t capacity, const Allocator& alloc = Allocator())
+            : table(capacity == 0 ? 1 : capacity, BucketAllocator(alloc)), totalElements(0), maxLoad(1), oldTable(BucketAllocator(alloc)),
+              migrated(0), migrationStep(0) {}
+        HashTableBase(const HashTableBase& other)
+            : table(other.table, std::allocator_traits<BucketAllocator>::select_on_container_copy_construction(other.table.get_allocator())),
+              totalElements(other.totalElements), maxLoad(other.maxLoad), oldTable(other.oldTable, table.get_allocator()),
+              migrated(other.migrated), migrationStep(other.migrationStep) {}
+        HashTableBase& operator=(const HashTableBase& other) {
             if (this == &other)
             {
                 return *this;
             }
-            vector<list<Key>> newTable (other.table.capacity());
-            for (size_t i = 0; i < other.table.size(); i++)
-            {
-                newTable.at(i) = other.table.at(i);
-            }
+            BucketTable newTable (other.table, table.get_allocator());
+            BucketTable newOldTable (other.oldTable, table.get_allocator());
             table.swap(newTable);
+            oldTable.swap(newOldTable);
             totalElements = other.totalElements;
             maxLoad = other.maxLoad;
+            migrated = other.migrated;
+            migrationStep = other.migrationStep;
             return *this;
         }
-        ~HashTable() {
+        ~HashTableBase() {
             for (size_t i = 0; i < table.size(); i++)
             {
                 table.at(i).clear(); // clears each linked list in the vector
             }
             table.clear(); // clears the vector
+            oldTable.clear();
+        }
+
+        Allocator get_allocator() const {
+            return Allocator(table.get_allocator());
         }
 
         bool is_empty() const {
@@ -61,79 +120,51 @@ class HashTable {
             {
                 table.at(i).clear(); // clears each linked list in the vector
             }
+            endMigration();
         }
 
-        bool insert(const Key& key) 
+        size_t remove(const Key& key)
         {
-            if (contains(key))
-            {
-                return false;
-            }
-            size_t hash_value = Hash {} (key) % table.capacity();
-            table.at(hash_value).push_back(key);
-            totalElements++;
-            if (load_factor() > maxLoad)
-            {
-                size_t nextPrime = getNextPrime(2*table.capacity());
-                rehash(nextPrime);   
-            }
-            return true;
+            return removeKey(key);
         }
-
-        size_t remove(const Key& key)
+        template <class K, class = EnableTransparent<K>>
+        size_t remove(const K& key)
         {
-            if (!contains(key))
-            {
-                return 0;
-            }
-            size_t hash_value = Hash {} (key) % table.capacity();
-            for (const Key& value : table.at(hash_value))
-            {
-                if (value == key)
-                {
-                    table.at(hash_value).remove(value);
-                    totalElements--;
-                    break;
-                }
-            }
-            return 1;
+            return removeKey(key);
         }
 
         bool contains(const Key& key) const
         {
-            size_t hash_value = Hash {} (key) % table.capacity();
-            for (const Key& value : table.at(hash_value))
-            {
-                if (value == key)
-                {
-                    return true;
-                }
-            }
-            return false;
+            return findElement(key) != nullptr;
+        }
+        template <class K, class = EnableTransparent<K>>
+        bool contains(const K& key) const
+        {
+            return findElement(key) != nullptr;
         }
 
         size_t bucket_count() const {
-            return table.capacity();
+            return table.size();
         }
 
         size_t bucket_size(size_t index) const
         {
-            if (index > table.size() || index >= table.capacity())
+            if (index >= table.size())
                 throw std::out_of_range("");
             return table.at(index).size();
         }
 
-        
+
         size_t bucket(const Key& key) const {
-            return (Hash {} (key) % table.capacity()); 
+            return (Hash {} (key) % table.size());
         }
 
         float load_factor() const {
-            if (table.capacity() == 0)
+            if (table.size() == 0)
             {
                 return 0;
             }
-            return (float) totalElements / table.capacity();
+            return (float) totalElements / table.size();
         }
 
         float max_load_factor() const {
@@ -148,34 +179,47 @@ class HashTable {
             maxLoad = newMax;
             if (load_factor() > maxLoad)
             {
-                size_t nextPrime = getNextPrime(2*table.capacity());
+                size_t nextPrime = getNextPrime(2*table.size());
                 rehash(nextPrime);
             }
         }
 
+        // Resizes in one go.
         void rehash(size_t newCap) {
-            size_t oldCap = table.capacity();
-            if (((float) totalElements / newCap) > maxLoad)
-            {
-                newCap = getNextPrime(size() / max_load_factor());
-            }
-            vector<list<Key>> newTable (newCap);
+            finish_migration();
+            size_t oldCap = table.size();
+            newCap = checkedCapacity(newCap);
+            BucketTable newTable (newCap, table.get_allocator());
             if (newCap != oldCap) // number of buckets has changed
             {
                 for (size_t i = 0; i < oldCap; i++) // was previously old size
                 {
-                    if (!table.at(i).empty())
-                    {
-                        for (const Key& value : table.at(i))
-                        {
-                            newTable.at(Hash {} (value) % newTable.capacity()).push_back(value);
-                        }
-                    }
+                    moveBucket(table.at(i), newTable);
                 }
                 table.swap(newTable); // was outside, may have caused issues
             }
         }
 
+        // Old buckets spliced over per insert or remove while a resize is in progress;
+        // 0 (the default) resizes all at once.
+        size_t rehash_step() const {
+            return migrationStep;
+        }
+        void rehash_step(size_t step) {
+            migrationStep = step;
+            if (step == 0)
+            {
+                finish_migration();
+            }
+        }
+        // Old buckets still to be moved, 0 when no resize is in progress.
+        size_t pending_migration() const {
+            return oldTable.size() - migrated;
+        }
+        void finish_migration() {
+            migrate(oldTable.size());
+        }
+
         void print_table(std::ostream& os =std::cout) const
         {
             if (totalElements == 0)
@@ -188,9 +232,25 @@ class HashTable {
                 if (!table.at(i).empty())
                 {
                     os << i << ": [";
-                    for (const Key& value : table.at(i))
+                    for (const Element& value : table.at(i))
+                    {
+                        os << " | ";
+                        ElementPolicy::print(os, value);
+                        os << " | ";
+                    }
+                    os << "]\n";
+                }
+            }
+            for (size_t i = migrated; i < oldTable.size(); i++)
+            {
+                if (!oldTable.at(i).empty())
+                {
+                    os << "old " << i << ": [";
+                    for (const Element& value : oldTable.at(i))
                     {
-                        os << " | " << value << " | ";
+                        os << " | ";
+                        ElementPolicy::print(os, value);
+                        os << " | ";
                     }
                     os << "]\n";
                 }
@@ -199,13 +259,13 @@ class HashTable {
 
         bool isPrime(int n)
         {
-            if (n <= 1)  
+            if (n <= 1)
                 return false;
-            if (n <= 3)  
+            if (n <= 3)
                 return true;
-            if (n % 2 == 0 || n % 3 == 0) 
+            if (n % 2 == 0 || n % 3 == 0)
                 return false;
-        
+
             for (int i = 5; i * i <= n; i+=6)
             {
                 if (n % i == 0 || n % (i + 2) == 0)
@@ -229,7 +289,288 @@ class HashTable {
             }
         }
 
+    protected:
+        template <class K>
+        Element* findElement(const K& key)
+        {
+            return findElement(key, Hash {} (key));
+        }
+        template <class K>
+        const Element* findElement(const K& key) const
+        {
+            return findElement(key, Hash {} (key));
+        }
+        template <class K>
+        Element* findElement(const K& key, size_t hash_value)
+        {
+            return const_cast<Element*>(static_cast<const HashTableBase&>(*this).findElement(key, hash_value));
+        }
+        template <class K>
+        const Element* findElement(const K& key, size_t hash_value) const
+        {
+            for (const Element& value : table.at(hash_value % table.size()))
+            {
+                if (KeyEqual {} (ElementPolicy::key(value), key))
+                {
+                    return &value;
+                }
+            }
+            const Bucket* oldBucket = unmigratedBucket(hash_value);
+            if (oldBucket != nullptr)
+            {
+                for (const Element& value : *oldBucket)
+                {
+                    if (KeyEqual {} (ElementPolicy::key(value), key))
+                    {
+                        return &value;
+                    }
+                }
+            }
+            return nullptr;
+        }
+
+        // Builds the element from args only when key is not in the table yet, after one
+        // walk of its bucket. The table grows before the element goes in, so the bucket
+        // does not have to be looked up twice for an existing key.
+        template <class K, class... Args>
+        std::pair<Element*, bool> emplaceUnique(const K& key, Args&&... args)
+        {
+            migrate(migrationStep);
+            size_t hash_value = Hash {} (key);
+            Element* existing = findElement(key, hash_value);
+            if (existing != nullptr)
+            {
+                return {existing, false};
+            }
+            if (((float) (totalElements + 1) / table.size()) > maxLoad)
+            {
+                grow();
+            }
+            Bucket& bucket = table.at(hash_value % table.size()); // grow only changes the index
+            bucket.emplace_back(std::forward<Args>(args)...);
+            totalElements++;
+            return {&bucket.back(), true};
+        }
+
+    private:
+        template <class K>
+        size_t removeKey(const K& key)
+        {
+            migrate(migrationStep);
+            size_t hash_value = Hash {} (key);
+            if (eraseFrom(table.at(hash_value % table.size()), key))
+            {
+                return 1;
+            }
+            Bucket* oldBucket = const_cast<Bucket*>(unmigratedBucket(hash_value));
+            return oldBucket != nullptr && eraseFrom(*oldBucket, key) ? 1 : 0;
+        }
+        template <class K>
+        bool eraseFrom(Bucket& bucket, const K& key)
+        {
+            for (auto it = bucket.begin(); it != bucket.end(); ++it)
+            {
+                if (KeyEqual {} (ElementPolicy::key(*it), key))
+                {
+                    bucket.erase(it);
+                    totalElements--;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // The old bucket a hash maps to, when it has not been moved yet.
+        const Bucket* unmigratedBucket(size_t hash_value) const
+        {
+            if (oldTable.empty())
+            {
+                return nullptr;
+            }
+            size_t index = hash_value % oldTable.size();
+            return index >= migrated ? &oldTable.at(index) : nullptr;
+        }
+
+        // Relinks the nodes instead of copying, so elements never move in memory.
+        static void moveBucket(Bucket& from, BucketTable& to)
+        {
+            while (!from.empty())
+            {
+                Bucket& target = to.at(Hash {} (ElementPolicy::key(from.front())) % to.size());
+                target.splice(target.end(), from, from.begin());
+            }
+        }
+
+        size_t checkedCapacity(size_t newCap)
+        {
+            if (((float) totalElements / newCap) > maxLoad)
+            {
+                newCap = getNextPrime(size() / max_load_factor());
+            }
+            return newCap;
+        }
+        void grow()
+        {
+            size_t nextPrime = getNextPrime(2*table.size());
+            if (migrationStep == 0)
+            {
+                rehash(nextPrime);
+                return;
+            }
+            finish_migration(); // only one resize in flight at a time
+            BucketTable bigger (checkedCapacity(nextPrime), table.get_allocator());
+            oldTable.swap(table);
+            table.swap(bigger);
+            migrated = 0;
+        }
+        // Splices up to buckets old buckets into the current table.
+        void migrate(size_t buckets)
+        {
+            if (oldTable.empty())
+                return;
+            size_t end = oldTable.size() - migrated < buckets ? oldTable.size() : migrated + buckets;
+            for (; migrated < end; migrated++)
+            {
+                moveBucket(oldTable.at(migrated), table);
+            }
+            if (migrated == oldTable.size())
+            {
+                endMigration();
+            }
+        }
+        void endMigration()
+        {
+            BucketTable released (table.get_allocator());
+            oldTable.swap(released);
+            migrated = 0;
+        }
+};
+
+template <class Key, class Hash=std::hash<Key>, class KeyEqual=std::equal_to<Key>, class Allocator=std::allocator<Key>>
+class HashTable : public HashTableBase<Key, HashSetElement<Key>, Hash, KeyEqual, Allocator> {
+    using Base = HashTableBase<Key, HashSetElement<Key>, Hash, KeyEqual, Allocator>;
+    public:
+        using Base::Base;
 
+        bool insert(const Key& key)
+        {
+            return this->emplaceUnique(key, key).second;
+        }
+        bool insert(Key&& key)
+        {
+            return this->emplaceUnique(key, std::move(key)).second;
+        }
 };
 
+// Key to value map on the same engine. find hands back a pointer to the value, or
+// nullptr, so one bucket walk serves both the lookup and an update through the pointer.
+template <class Key, class Value, class Hash=std::hash<Key>, class KeyEqual=std::equal_to<Key>,
+          class Allocator=std::allocator<std::pair<const Key, Value>>>
+class HashMap : public HashTableBase<Key, HashMapElement<Key, Value>, Hash, KeyEqual, Allocator> {
+    using Base = HashTableBase<Key, HashMapElement<Key, Value>, Hash, KeyEqual, Allocator>;
+    template <class K>
+    using EnableTransparent = typename Base::template EnableTransparent<K>;
+
+    public:
+        using Base::Base;
+
+        Value* find(const Key& key)
+        {
+            return valueOf(this->findElement(key));
+        }
+        const Value* find(const Key& key) const
+        {
+            return valueOf(this->findElement(key));
+        }
+        template <class K, class = EnableTransparent<K>>
+        Value* find(const K& key)
+        {
+            return valueOf(this->findElement(key));
+        }
+        template <class K, class = EnableTransparent<K>>
+        const Value* find(const K& key) const
+        {
+            return valueOf(this->findElement(key));
+        }
+
+        Value& at(const Key& key)
+        {
+            Value* value = find(key);
+            if (value == nullptr)
+            {
+                throw std::out_of_range("");
+            }
+            return *value;
+        }
+        const Value& at(const Key& key) const
+        {
+            const Value* value = find(key);
+            if (value == nullptr)
+            {
+                throw std::out_of_range("");
+            }
+            return *value;
+        }
+
+        Value& operator[](const Key& key)
+        {
+            return *try_emplace(key).first;
+        }
+        Value& operator[](Key&& key)
+        {
+            return *try_emplace(std::move(key)).first;
+        }
+
+        // Leaves an existing value alone; args are only used when the key is new.
+        template <class... Args>
+        std::pair<Value*, bool> try_emplace(const Key& key, Args&&... args)
+        {
+            auto result = this->emplaceUnique(key, std::piecewise_construct, std::forward_as_tuple(key),
+                                              std::forward_as_tuple(std::forward<Args>(args)...));
+            return {&result.first->second, result.second};
+        }
+        template <class... Args>
+        std::pair<Value*, bool> try_emplace(Key&& key, Args&&... args)
+        {
+            auto result = this->emplaceUnique(key, std::piecewise_construct, std::forward_as_tuple(std::move(key)),
+                                              std::forward_as_tuple(std::forward<Args>(args)...));
+            return {&result.first->second, result.second};
+        }
+
+        // Returns true when the key was new, false when an existing value was replaced.
+        template <class V>
+        std::pair<Value*, bool> insert_or_assign(const Key& key, V&& value)
+        {
+            std::pair<Value*, bool> result = try_emplace(key, std::forward<V>(value));
+            if (!result.second)
+            {
+                *result.first = std::forward<V>(value);
+            }
+            return result;
+        }
+        template <class V>
+        std::pair<Value*, bool> insert_or_assign(Key&& key, V&& value)
+        {
+            std::pair<Value*, bool> result = try_emplace(std::move(key), std::forward<V>(value));
+            if (!result.second)
+            {
+                *result.first = std::forward<V>(value);
+            }
+            return result;
+        }
+
+    private:
+        template <class E>
+        static auto valueOf(E* element) -> decltype(&element->second)
+        {
+            return element == nullptr ? nullptr : &element->second;
+        }
+};
+
+template <class Key, class Hash=std::hash<Key>, class KeyEqual=std::equal_to<Key>>
+using PmrHashTable = HashTable<Key, Hash, KeyEqual, std::pmr::polymorphic_allocator<Key>>;
+
+template <class Key, class Value, class Hash=std::hash<Key>, class KeyEqual=std::equal_to<Key>>
+using PmrHashMap = HashMap<Key, Value, Hash, KeyEqual, std::pmr::polymorphic_allocator<std::pair<const Key, Value>>>;
+
 #endif  // HASHTABLE_SEPARATE_CHAINING_H
\ No newline at end of file
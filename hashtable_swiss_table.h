@@ -0,0 +1,516 @@
+#ifndef HASHTABLE_SWISS_TABLE_H
+#define HASHTABLE_SWISS_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <memory_resource>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SWISS_TABLE_SSE2 1
+#else
+#define SWISS_TABLE_SSE2 0
+#endif
+
+// Open addressing hash set in the style of Swiss tables. Next to the slots there is an
+// array of one byte control words: EMPTY, DELETED, or the low 7 bits of the hash (h2)
+// of the key in the slot. A lookup compares h2 against a whole group of 16 control
+// bytes at once (SSE2 when available) and only looks at the keys that match, so a
+// typical lookup touches one control cache line and one slot.
+// The capacity is a power of two, the table grows at 7/8 load, and the hash goes through
+// a multiply mixer first so weak hashes (like std::hash on integers) still spread.
+template <class Key, class Hash=std::hash<Key>, class KeyEqual=std::equal_to<Key>, class Allocator=std::allocator<Key>>
+class SwissTable {
+    private:
+        using ctrl_t = int8_t;
+        static constexpr ctrl_t EMPTY = -128; // 0b10000000
+        static constexpr ctrl_t DELETED = -2; // 0b11111110, full slots are 0b0xxxxxxx
+        static constexpr size_t GroupWidth = 16;
+        static constexpr size_t MinCapacity = GroupWidth;
+
+        using AllocTraits = std::allocator_traits<Allocator>;
+        using CtrlAllocator = typename AllocTraits::template rebind_alloc<ctrl_t>;
+        using CtrlTraits = std::allocator_traits<CtrlAllocator>;
+
+        // Bit i is set when control byte i of the group matched.
+        class BitMask {
+            uint32_t mask;
+            public:
+                explicit BitMask(uint32_t m) : mask(m) {}
+                explicit operator bool() const {
+                    return mask != 0;
+                }
+                size_t lowest() const {
+                    return trailingZeros(mask);
+                }
+                void clearLowest() {
+                    mask &= mask - 1;
+                }
+                // Misses before the first match, counted from the low end.
+                size_t trailingMisses() const {
+                    return mask == 0 ? GroupWidth : trailingZeros(mask);
+                }
+                // Misses after the last match, counted from the high end.
+                size_t leadingMisses() const {
+                    size_t count = 0;
+                    for (uint32_t bit = 1u << (GroupWidth - 1); bit != 0 && (mask & bit) == 0; bit >>= 1)
+                    {
+                        count++;
+                    }
+                    return count;
+                }
+        };
+
+        struct Group {
+#if SWISS_TABLE_SSE2
+            __m128i ctrl;
+            explicit Group(const ctrl_t* pos) : ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pos))) {}
+            BitMask match(ctrl_t h2) const {
+                return BitMask((uint32_t) _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl)));
+            }
+            BitMask matchEmpty() const {
+                return match(EMPTY);
+            }
+            // EMPTY and DELETED are the only negative control bytes
+            BitMask matchEmptyOrDeleted() const {
+                return BitMask((uint32_t) _mm_movemask_epi8(ctrl));
+            }
+#else
+            ctrl_t ctrl[GroupWidth];
+            explicit Group(const ctrl_t* pos) {
+                std::memcpy(ctrl, pos, GroupWidth);
+            }
+            BitMask match(ctrl_t h2) const {
+                uint32_t mask = 0;
+                for (size_t i = 0; i < GroupWidth; i++)
+                {
+                    mask |= (uint32_t) (ctrl[i] == h2) << i;
+                }
+                return BitMask(mask);
+            }
+            BitMask matchEmpty() const {
+                return match(EMPTY);
+            }
+            BitMask matchEmptyOrDeleted() const {
+                uint32_t mask = 0;
+                for (size_t i = 0; i < GroupWidth; i++)
+                {
+                    mask |= (uint32_t) (ctrl[i] < 0) << i;
+                }
+                return BitMask(mask);
+            }
+#endif
+        };
+
+        Hash hasher;
+        KeyEqual equal;
+        Allocator alloc;
+        ctrl_t* ctrl; // _capacity + GroupWidth bytes, the tail mirrors the first GroupWidth
+        Key* slots;
+        size_t _capacity;
+        size_t totalElements;
+        size_t deletedCount;
+
+    public:
+        using allocator_type = Allocator;
+
+        SwissTable() : SwissTable(MinCapacity) {}
+        explicit SwissTable(const Allocator& allocator) : SwissTable(MinCapacity, allocator) {}
+        // Room for capacity elements without growing.
+        explicit SwissTable(size_t capacity, const Allocator& allocator = Allocator())
+            : hasher(), equal(), alloc(allocator), ctrl(nullptr), slots(nullptr), _capacity(0), totalElements(0), deletedCount(0)
+        {
+            allocateTable(capacityFor(capacity));
+        }
+        SwissTable(const SwissTable& other)
+            : hasher(other.hasher), equal(other.equal), alloc(AllocTraits::select_on_container_copy_construction(other.alloc)),
+              ctrl(nullptr), slots(nullptr), _capacity(0), totalElements(0), deletedCount(0)
+        {
+            allocateTable(capacityFor(other.totalElements));
+            try
+            {
+                copyFrom(other);
+            }
+            catch (...)
+            {
+                destroyTable();
+                throw;
+            }
+        }
+        SwissTable(SwissTable&& other) noexcept
+            : hasher(std::move(other.hasher)), equal(std::move(other.equal)), alloc(std::move(other.alloc)),
+              ctrl(other.ctrl), slots(other.slots), _capacity(other._capacity), totalElements(other.totalElements),
+              deletedCount(other.deletedCount)
+        {
+            other.ctrl = nullptr;
+            other.slots = nullptr;
+            other._capacity = 0;
+            other.totalElements = 0;
+            other.deletedCount = 0;
+        }
+        SwissTable& operator=(const SwissTable& other) {
+            if (this == &other)
+            {
+                return *this;
+            }
+            destroyTable();
+            hasher = other.hasher;
+            equal = other.equal;
+            if constexpr (AllocTraits::propagate_on_container_copy_assignment::value)
+            {
+                alloc = other.alloc;
+            }
+            allocateTable(capacityFor(other.totalElements));
+            copyFrom(other);
+            return *this;
+        }
+        SwissTable& operator=(SwissTable&& other) {
+            if (this == &other)
+            {
+                return *this;
+            }
+            destroyTable();
+            hasher = std::move(other.hasher);
+            equal = std::move(other.equal);
+            if constexpr (AllocTraits::propagate_on_container_move_assignment::value)
+            {
+                alloc = std::move(other.alloc);
+            }
+            else if (alloc != other.alloc)
+            {
+                allocateTable(capacityFor(other.totalElements));
+                copyFrom(other);
+                other.make_empty();
+                return *this;
+            }
+            ctrl = other.ctrl;
+            slots = other.slots;
+            _capacity = other._capacity;
+            totalElements = other.totalElements;
+            deletedCount = other.deletedCount;
+            other.ctrl = nullptr;
+            other.slots = nullptr;
+            other._capacity = 0;
+            other.totalElements = 0;
+            other.deletedCount = 0;
+            return *this;
+        }
+        ~SwissTable() {
+            destroyTable();
+        }
+
+        Allocator get_allocator() const {
+            return alloc;
+        }
+        bool is_empty() const {
+            return totalElements == 0;
+        }
+        size_t size() const {
+            return totalElements;
+        }
+        size_t table_size() const {
+            return _capacity;
+        }
+        void make_empty() {
+            if (ctrl == nullptr)
+            {
+                return; // moved from
+            }
+            for (size_t i = 0; i < _capacity; i++)
+            {
+                if (ctrl[i] >= 0)
+                {
+                    AllocTraits::destroy(alloc, slots + i);
+                }
+            }
+            std::memset(ctrl, (unsigned char) EMPTY, _capacity + GroupWidth);
+            totalElements = 0;
+            deletedCount = 0;
+        }
+
+        bool contains(const Key& x) const {
+            return find(x, hashOf(x)) != npos;
+        }
+
+        bool insert(const Key& x) {
+            return emplaceKey(x);
+        }
+        bool insert(Key&& x) {
+            return emplaceKey(std::move(x));
+        }
+
+        size_t remove(const Key& x) {
+            size_t index = find(x, hashOf(x));
+            if (index == npos)
+            {
+                return 0;
+            }
+            AllocTraits::destroy(alloc, slots + index);
+            totalElements--;
+            // a probe only moves past a group with no EMPTY byte in it; when the run of
+            // non-empty slots around this one is shorter than a group, no probe ever went
+            // past it and the slot can simply be EMPTY again
+            size_t before = (index - GroupWidth) & (_capacity - 1);
+            BitMask emptyBefore = Group(ctrl + before).matchEmpty();
+            BitMask emptyAfter = Group(ctrl + index).matchEmpty();
+            bool neverFull = emptyBefore && emptyAfter
+                             && emptyBefore.leadingMisses() + emptyAfter.trailingMisses() < GroupWidth;
+            if (neverFull)
+            {
+                setCtrl(index, EMPTY);
+            }
+            else
+            {
+                setCtrl(index, DELETED);
+                deletedCount++;
+            }
+            return 1;
+        }
+
+        void print_table(std::ostream& os =std::cout) const
+        {
+            if (totalElements == 0)
+            {
+                os << "<empty>\n";
+                return;
+            }
+            for (size_t i = 0; i < _capacity; i++)
+            {
+                if (ctrl[i] >= 0)
+                {
+                    os << i << ": " << slots[i] << "\n";
+                }
+            }
+        }
+
+    private:
+        static constexpr size_t npos = static_cast<size_t>(-1);
+
+        static size_t trailingZeros(uint32_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+            return x == 0 ? 32 : (size_t) __builtin_ctz(x);
+#else
+            size_t count = 0;
+            while (count < 32 && (x & 1) == 0)
+            {
+                x >>= 1;
+                count++;
+            }
+            return count;
+#endif
+        }
+
+        // Multiplies by a 64 bit odd constant and folds the high half of the 128 bit
+        // product into the low one, so every input bit reaches both h1 and h2.
+        size_t hashOf(const Key& x) const {
+            return (size_t) foldedMultiply((uint64_t) hasher(x), 0x9E3779B97F4A7C15ull);
+        }
+        static uint64_t foldedMultiply(uint64_t a, uint64_t b) {
+#if defined(__SIZEOF_INT128__)
+            __extension__ typedef unsigned __int128 Wide; // keeps -Wpedantic quiet
+            Wide product = (Wide) a * b;
+            return (uint64_t) product ^ (uint64_t) (product >> 64);
+#else
+            // the same high half out of 32 bit pieces
+            uint64_t aLow = a & 0xFFFFFFFF, aHigh = a >> 32;
+            uint64_t bLow = b & 0xFFFFFFFF, bHigh = b >> 32;
+            uint64_t lowLow = aLow * bLow, lowHigh = aLow * bHigh, highLow = aHigh * bLow;
+            uint64_t middle = (lowLow >> 32) + (lowHigh & 0xFFFFFFFF) + (highLow & 0xFFFFFFFF);
+            uint64_t high = aHigh * bHigh + (lowHigh >> 32) + (highLow >> 32) + (middle >> 32);
+            return (a * b) ^ high;
+#endif
+        }
+        static size_t h1(size_t hash) {
+            return hash >> 7;
+        }
+        static ctrl_t h2(size_t hash) {
+            return (ctrl_t) (hash & 0x7F);
+        }
+
+        static size_t capacityFor(size_t elements) {
+            size_t capacity = MinCapacity;
+            while (capacity / 8 * 7 < elements)
+            {
+                capacity *= 2;
+            }
+            return capacity;
+        }
+        size_t growthLimit() const {
+            return _capacity / 8 * 7;
+        }
+
+        void setCtrl(size_t index, ctrl_t value) {
+            ctrl[index] = value;
+            if (index < GroupWidth)
+            {
+                ctrl[_capacity + index] = value; // keep the mirrored tail in sync
+            }
+        }
+
+        // Probes group by group with growing strides, which visits every group once.
+        template <class K>
+        size_t find(const K& x, size_t hash) const {
+            if (_capacity == 0)
+            {
+                return npos;
+            }
+            size_t mask = _capacity - 1;
+            size_t pos = h1(hash) & mask;
+            size_t stride = 0;
+            for (;;)
+            {
+                Group group(ctrl + pos);
+                for (BitMask match = group.match(h2(hash)); match; match.clearLowest())
+                {
+                    size_t index = (pos + match.lowest()) & mask;
+                    if (equal(slots[index], x))
+                    {
+                        return index;
+                    }
+                }
+                if (group.matchEmpty())
+                {
+                    return npos;
+                }
+                stride += GroupWidth;
+                pos = (pos + stride) & mask;
+            }
+        }
+
+        // First EMPTY or DELETED slot on the probe sequence of hash.
+        size_t findFirstNonFull(size_t hash) const {
+            size_t mask = _capacity - 1;
+            size_t pos = h1(hash) & mask;
+            size_t stride = 0;
+            for (;;)
+            {
+                BitMask free = Group(ctrl + pos).matchEmptyOrDeleted();
+                if (free)
+                {
+                    return (pos + free.lowest()) & mask;
+                }
+                stride += GroupWidth;
+                pos = (pos + stride) & mask;
+            }
+        }
+
+        template <class K>
+        bool emplaceKey(K&& x) {
+            size_t hash = hashOf(x);
+            if (find(x, hash) != npos)
+            {
+                return false;
+            }
+            if (ctrl == nullptr)
+            {
+                allocateTable(MinCapacity);
+            }
+            size_t index = findFirstNonFull(hash);
+            if (ctrl[index] == EMPTY && totalElements + deletedCount >= growthLimit())
+            {
+                // a reused DELETED slot does not add load, anything else might need room first
+                rehash(totalElements + 1);
+                index = findFirstNonFull(hash);
+            }
+            AllocTraits::construct(alloc, slots + index, std::forward<K>(x));
+            if (ctrl[index] == DELETED)
+            {
+                deletedCount--;
+            }
+            setCtrl(index, h2(hash));
+            totalElements++;
+            return true;
+        }
+
+        // Rebuilds the table for at least the given number of elements. When tombstones are
+        // what filled it up, the capacity stays the same and they are simply dropped.
+        void rehash(size_t elements) {
+            size_t newCapacity = capacityFor(elements);
+            if (newCapacity < _capacity)
+            {
+                newCapacity = _capacity;
+            }
+            if (newCapacity == _capacity && elements > _capacity / 16 * 7)
+            {
+                newCapacity *= 2; // mostly live elements, cleaning would not buy much
+            }
+            ctrl_t* oldCtrl = ctrl;
+            Key* oldSlots = slots;
+            size_t oldCapacity = _capacity;
+            allocateTable(newCapacity);
+            for (size_t i = 0; i < oldCapacity; i++)
+            {
+                if (oldCtrl[i] >= 0)
+                {
+                    size_t hash = hashOf(oldSlots[i]);
+                    size_t index = findFirstNonFull(hash);
+                    AllocTraits::construct(alloc, slots + index, std::move_if_noexcept(oldSlots[i]));
+                    AllocTraits::destroy(alloc, oldSlots + i);
+                    setCtrl(index, h2(hash));
+                }
+            }
+            deletedCount = 0;
+            freeArrays(oldCtrl, oldSlots, oldCapacity);
+        }
+
+        void allocateTable(size_t capacity) {
+            CtrlAllocator ctrlAlloc(alloc);
+            ctrl_t* newCtrl = CtrlTraits::allocate(ctrlAlloc, capacity + GroupWidth);
+            try
+            {
+                slots = AllocTraits::allocate(alloc, capacity);
+            }
+            catch (...)
+            {
+                CtrlTraits::deallocate(ctrlAlloc, newCtrl, capacity + GroupWidth);
+                throw;
+            }
+            ctrl = newCtrl;
+            _capacity = capacity;
+            std::memset(ctrl, (unsigned char) EMPTY, capacity + GroupWidth);
+        }
+        void freeArrays(ctrl_t* oldCtrl, Key* oldSlots, size_t capacity) {
+            if (oldCtrl == nullptr)
+            {
+                return;
+            }
+            CtrlAllocator ctrlAlloc(alloc);
+            CtrlTraits::deallocate(ctrlAlloc, oldCtrl, capacity + GroupWidth);
+            AllocTraits::deallocate(alloc, oldSlots, capacity);
+        }
+        void destroyTable() {
+            if (ctrl == nullptr)
+            {
+                return;
+            }
+            make_empty();
+            freeArrays(ctrl, slots, _capacity);
+            ctrl = nullptr;
+            slots = nullptr;
+            _capacity = 0;
+        }
+
+        void copyFrom(const SwissTable& other) {
+            for (size_t i = 0; i < other._capacity; i++)
+            {
+                if (other.ctrl[i] >= 0)
+                {
+                    size_t hash = hashOf(other.slots[i]);
+                    size_t index = findFirstNonFull(hash);
+                    AllocTraits::construct(alloc, slots + index, other.slots[i]);
+                    setCtrl(index, h2(hash));
+                    totalElements++;
+                }
+            }
+        }
+};
+
+template <class Key, class Hash=std::hash<Key>, class KeyEqual=std::equal_to<Key>>
+using PmrSwissTable = SwissTable<Key, Hash, KeyEqual, std::pmr::polymorphic_allocator<Key>>;
+
+#endif  // HASHTABLE_SWISS_TABLE_H
@@ -0,0 +1,221 @@
+#ifndef HAZARD_POINTER_H
+#define HAZARD_POINTER_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+// Process wide hazard pointers for lock-free structures that unlink nodes while other
+// threads may still be reading them. Every thread owns one hazard slot: before it
+// dereferences a shared node it publishes the pointer with protect(), and a node that
+// has been unlinked is handed to retire() instead of being freed. Retired nodes are
+// only freed once no slot points at them, which also rules out ABA on the node address.
+class HazardPointers {
+    private:
+        static constexpr size_t ScanThreshold = 64;
+        static constexpr size_t RetiredCapacity = 2 * ScanThreshold;
+
+        struct Record {
+            std::atomic<const void*> hazard;
+            std::atomic<bool> active;
+            Record* next;
+        };
+        struct Retired {
+            void* pointer;
+            void (*deleter)(void*);
+        };
+        // Trivially destructible so it stays usable while other thread locals are torn down.
+        struct ThreadState {
+            Record* record;
+            Retired retired[RetiredCapacity];
+            size_t count;
+            bool registered;
+            bool closed;
+        };
+        struct ThreadFlusher {
+            ~ThreadFlusher()
+            {
+                ThreadState& s = state;
+                s.count = scan(s.retired, s.count);
+                orphan(s.retired, s.count);
+                s.count = 0;
+                if (s.record != nullptr)
+                {
+                    s.record->hazard.store(nullptr, std::memory_order_release);
+                    s.record->active.store(false, std::memory_order_release);
+                    s.record = nullptr;
+                }
+                s.closed = true;
+            }
+        };
+        static inline std::atomic<Record*> records{nullptr};
+        static inline thread_local ThreadState state{};
+        static inline thread_local ThreadFlusher flusher;
+
+    public:
+        // Reads src and publishes the result as this thread's hazard, retrying until the
+        // published value is still current. The result stays safe to dereference until
+        // clear() or the next protect() on this thread.
+        template <class T>
+        static T* protect(const std::atomic<T*>& src)
+        {
+            Record* r = record();
+            T* p = src.load(std::memory_order_relaxed);
+            for (;;)
+            {
+                r->hazard.store(p, std::memory_order_seq_cst);
+                T* again = src.load(std::memory_order_seq_cst);
+                if (again == p)
+                {
+                    return p;
+                }
+                p = again;
+            }
+        }
+
+        static void clear()
+        {
+            record()->hazard.store(nullptr, std::memory_order_release);
+        }
+
+        // Frees p with deleter once no thread has it protected. p must already be
+        // unreachable for threads that have not protected it yet.
+        static void retire(void* p, void (*deleter)(void*))
+        {
+            ThreadState& s = state;
+            if (s.closed)
+            {
+                // thread is exiting, let whoever scans next take care of it
+                Retired late[1] = {{p, deleter}};
+                orphan(late, 1);
+                return;
+            }
+            s.retired[s.count++] = Retired{p, deleter};
+            if (s.count >= ScanThreshold)
+            {
+                s.count = scan(s.retired, s.count);
+                if (s.count == RetiredCapacity)
+                {
+                    // more hazards than we can hold on to, park them globally
+                    orphan(s.retired, s.count);
+                    s.count = 0;
+                }
+            }
+        }
+
+    private:
+        static Record* record()
+        {
+            ThreadState& s = state;
+            if (s.record == nullptr)
+            {
+                if (!s.registered && !s.closed)
+                {
+                    s.registered = true;
+                    (void) &flusher; // first use sets up the release at thread exit
+                }
+                // a thread that is already exiting keeps its slot for good
+                s.record = acquireRecord();
+            }
+            return s.record;
+        }
+
+        static Record* acquireRecord()
+        {
+            for (Record* r = records.load(std::memory_order_acquire); r != nullptr; r = r->next)
+            {
+                bool expected = false;
+                if (!r->active.load(std::memory_order_relaxed)
+                    && r->active.compare_exchange_strong(expected, true, std::memory_order_acquire))
+                {
+                    return r;
+                }
+            }
+            // records are never freed, other threads may be scanning them at any time
+            Record* r = new Record;
+            r->hazard.store(nullptr, std::memory_order_relaxed);
+            r->active.store(true, std::memory_order_relaxed);
+            r->next = records.load(std::memory_order_relaxed);
+            while (!records.compare_exchange_weak(r->next, r, std::memory_order_release, std::memory_order_relaxed))
+            {
+            }
+            return r;
+        }
+
+        // Frees every entry of list that no thread has protected, compacts the rest to
+        // the front and returns how many are left.
+        static size_t scan(Retired* list, size_t count)
+        {
+            std::vector<const void*> hazards;
+            for (Record* r = records.load(std::memory_order_acquire); r != nullptr; r = r->next)
+            {
+                const void* p = r->hazard.load(std::memory_order_seq_cst);
+                if (p != nullptr)
+                {
+                    hazards.push_back(p);
+                }
+            }
+            std::sort(hazards.begin(), hazards.end());
+            size_t kept = 0;
+            for (size_t i = 0; i < count; i++)
+            {
+                if (std::binary_search(hazards.begin(), hazards.end(), static_cast<const void*>(list[i].pointer)))
+                {
+                    list[kept++] = list[i];
+                }
+                else
+                {
+                    list[i].deleter(list[i].pointer);
+                }
+            }
+            reclaimOrphans(hazards);
+            return kept;
+        }
+
+        // Nodes left behind by exited threads; never destroyed so exit order does not matter.
+        static std::mutex& orphanLock()
+        {
+            static std::mutex* lock = new std::mutex;
+            return *lock;
+        }
+        static std::vector<Retired>& orphans()
+        {
+            static std::vector<Retired>* list = new std::vector<Retired>;
+            return *list;
+        }
+        static void orphan(const Retired* list, size_t count)
+        {
+            if (count == 0)
+            {
+                return;
+            }
+            std::lock_guard<std::mutex> guard(orphanLock());
+            orphans().insert(orphans().end(), list, list + count);
+        }
+        static void reclaimOrphans(const std::vector<const void*>& hazards)
+        {
+            std::unique_lock<std::mutex> guard(orphanLock(), std::try_to_lock);
+            if (!guard.owns_lock())
+            {
+                return;
+            }
+            std::vector<Retired>& list = orphans();
+            size_t kept = 0;
+            for (size_t i = 0; i < list.size(); i++)
+            {
+                if (std::binary_search(hazards.begin(), hazards.end(), static_cast<const void*>(list[i].pointer)))
+                {
+                    list[kept++] = list[i];
+                }
+                else
+                {
+                    list[i].deleter(list[i].pointer);
+                }
+            }
+            list.resize(kept);
+        }
+};
+
+#endif  // HAZARD_POINTER_H
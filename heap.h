@@ -5,117 +5,188 @@
 #include <deque> 
 #include <initializer_list> 
 #include <iostream> 
+#include <iterator>
 #include <sstream> 
 #include <stdexcept> 
+#include <utility>
 #include <vector>
 
 using std::vector, std::cout, std::endl;
 
-template <class Container, class Compare=std::less<typename Container::value_type>>
-void percolateDown (size_t holeIndex, Container* container, Compare comp=std::less<typename Container::value_type>{}) // TOFIX: 80 and 60 didn't get swapped. Also alternaive to adjusting hole index? maybe insert 0
+// Heap over any random-access range, stored from index 0: the children of i are
+// Arity * i + 1 up to Arity * i + Arity, Arity defaults to a binary heap. A wider heap is
+// shallower and keeps the children of a node next to each other in memory, which helps
+// big heaps whose pops are bound on cache misses (4 and 8 are the usual choices).
+// comp(a, b) means a belongs above b, so std::less gives a min-heap.
+// Elements are moved into a hole instead of swapped, one move per level.
+// The names carry a heap_ prefix so they never clash with std::make_heap & co through ADL.
+
+// Drops value into the hole at holeIndex and moves it down until both children are below it.
+template <size_t Arity=2, class RandomIt, class T, class Compare>
+void heap_place_down(RandomIt first, size_t size, size_t holeIndex, T&& value, Compare comp)
 {
+    static_assert(Arity >= 2, "a heap needs at least two children per node");
     size_t childIndex;
-    typename Container::value_type temp = container->at(holeIndex);
-    //cout << "Temp is: " << temp << endl;
-    while (holeIndex * 2 <= container->size()-1) // the -1 accounts for indexed at 1, actual container has an index 0 but we ignore it
+    while ((childIndex = holeIndex * Arity + 1) < size)
     {
-        childIndex = holeIndex * 2; // hole at left child
-        if (childIndex != container->size()-1 && comp(container->at(childIndex + 1), container->at(childIndex))) // if there's a right child and the right child is smaller than the left
+        // pick the child that belongs highest
+        size_t lastChild = childIndex + Arity < size ? childIndex + Arity : size;
+        for (size_t sibling = childIndex + 1; sibling < lastChild; sibling++)
         {
-            childIndex += 1;
+            if (comp(first[sibling], first[childIndex]))
+            {
+                childIndex = sibling;
+            }
         }
-        if (comp(container->at(childIndex), container->at(holeIndex))) // child < hole then swap them
+        if (!comp(first[childIndex], value))
         {
-            temp = container->at(holeIndex);
-            container->at(holeIndex) = container->at(childIndex);
-            container->at(childIndex) = temp;
-            holeIndex = childIndex;
+            break;
         }
-        else
+        first[holeIndex] = std::move(first[childIndex]);
+        holeIndex = childIndex;
+    }
+    first[holeIndex] = std::forward<T>(value);
+}
+
+template <size_t Arity=2, class RandomIt, class Compare=std::less<typename std::iterator_traits<RandomIt>::value_type>>
+void heap_sift_down(RandomIt first, size_t size, size_t holeIndex, Compare comp=Compare{})
+{
+    if (holeIndex >= size)
+    {
+        return;
+    }
+    typename std::iterator_traits<RandomIt>::value_type value = std::move(first[holeIndex]);
+    heap_place_down<Arity>(first, size, holeIndex, std::move(value), comp);
+}
+
+template <size_t Arity=2, class RandomIt, class Compare=std::less<typename std::iterator_traits<RandomIt>::value_type>>
+void heap_sift_up(RandomIt first, size_t holeIndex, Compare comp=Compare{})
+{
+    typename std::iterator_traits<RandomIt>::value_type value = std::move(first[holeIndex]);
+    while (holeIndex > 0)
+    {
+        size_t parentIndex = (holeIndex - 1) / Arity;
+        if (!comp(value, first[parentIndex]))
         {
             break;
         }
+        first[holeIndex] = std::move(first[parentIndex]);
+        holeIndex = parentIndex;
     }
+    first[holeIndex] = std::move(value);
 }
 
-template <class Container, class Compare=std::less<typename Container::value_type>>
-void heapify(Container* container, Compare comp=std::less<typename Container::value_type>{})
+// Turns [first, last) into a heap in place, O(n).
+template <size_t Arity=2, class RandomIt, class Compare=std::less<typename std::iterator_traits<RandomIt>::value_type>>
+void heap_make(RandomIt first, RandomIt last, Compare comp=Compare{})
 {
-    //Container newContainer (container->size()+1);
-    Container newContainer(*container);
-    newContainer.push_back(typename Container::value_type());
-    //newContainer.resize(container->size()+1);
-    //newContainer.at(0) = typename Container::value_type();
-    size_t j = 0;
-    for (size_t i = 1; i < container->size()+1; i++)
+    size_t size = last - first;
+    if (size < 2)
     {
-        newContainer.at(i) = container->at(j);
-        j++;
+        return;
     }
-    newContainer.at(0) = typename Container::value_type();
-    for (size_t i = (newContainer.size() - 1) / 2; i > 0; i--)
+    // start from the parent of the last element
+    for (size_t i = (size - 2) / Arity + 1; i > 0; i--)
     {
-        percolateDown(i, &newContainer, comp);
+        heap_sift_down<Arity>(first, size, i - 1, comp);
     }
-    *container = newContainer;
-    
 }
 
-template <class Container, class Compare=std::less<typename Container::value_type>>
-void heap_insert(Container* container, const typename Container::value_type& value, Compare comp=std::less<typename Container::value_type>{})
+// [first, last - 1) is a heap, moves the element at last - 1 into place.
+template <size_t Arity=2, class RandomIt, class Compare=std::less<typename std::iterator_traits<RandomIt>::value_type>>
+void heap_push(RandomIt first, RandomIt last, Compare comp=Compare{})
 {
-    if (container->empty())
+    if (last - first > 1)
     {
-        heapify(container);
+        heap_sift_up<Arity>(first, last - first - 1, comp);
     }
-    container->push_back(value);
-    int holeIndex = container->size() - 1;
-    typename Container::value_type temp;
+}
 
-    while (comp(value,container->at(holeIndex/2)) && holeIndex != 1)
+// Moves the top to last - 1 and leaves [first, last - 1) a heap.
+template <size_t Arity=2, class RandomIt, class Compare=std::less<typename std::iterator_traits<RandomIt>::value_type>>
+void heap_pop(RandomIt first, RandomIt last, Compare comp=Compare{})
+{
+    size_t size = last - first;
+    if (size < 2)
     {
-        temp = container->at(holeIndex/2);
-        container->at(holeIndex/2) = value;
-        container->at(holeIndex) = temp;
-        holeIndex /= 2;
+        return;
     }
+    typename std::iterator_traits<RandomIt>::value_type value = std::move(first[size - 1]);
+    first[size - 1] = std::move(first[0]);
+    heap_place_down<Arity>(first, size - 1, 0, std::move(value), comp);
+}
 
+// Heap shape for PriorityQueue, picks the arity at compile time.
+template <size_t Arity>
+struct DaryHeapPolicy {
+    static constexpr size_t arity = Arity;
 
+    template <class RandomIt, class Compare>
+    static void make(RandomIt first, RandomIt last, Compare comp)
+    {
+        heap_make<Arity>(first, last, comp);
+    }
+    template <class RandomIt, class Compare>
+    static void push(RandomIt first, RandomIt last, Compare comp)
+    {
+        heap_push<Arity>(first, last, comp);
+    }
+    template <class RandomIt, class Compare>
+    static void pop(RandomIt first, RandomIt last, Compare comp)
+    {
+        heap_pop<Arity>(first, last, comp);
+    }
+};
+
+using BinaryHeapPolicy = DaryHeapPolicy<2>;
+
+// Container versions, the heap is the whole container.
+
+template <class Container, class Compare=std::less<typename Container::value_type>>
+void percolateDown (size_t holeIndex, Container* container, Compare comp=std::less<typename Container::value_type>{})
+{
+    heap_sift_down(container->begin(), container->size(), holeIndex, comp);
+}
+
+template <class Container, class Compare=std::less<typename Container::value_type>>
+void heapify(Container* container, Compare comp=std::less<typename Container::value_type>{})
+{
+    heap_make(container->begin(), container->end(), comp);
+}
+
+template <class Container, class Compare=std::less<typename Container::value_type>>
+void heap_insert(Container* container, const typename Container::value_type& value, Compare comp=std::less<typename Container::value_type>{})
+{
+    container->push_back(value);
+    heap_push(container->begin(), container->end(), comp);
+}
+
+template <class Container, class Compare=std::less<typename Container::value_type>>
+void heap_insert(Container* container, typename Container::value_type&& value, Compare comp=std::less<typename Container::value_type>{})
+{
+    container->push_back(std::move(value));
+    heap_push(container->begin(), container->end(), comp);
 }
 
 template <class Container>
 const typename Container::value_type& heap_get_min(const Container& container)
 {
-    if (container.empty()) // if even the 0th index doesn't exist for some reason
-    {
-        throw std::invalid_argument("Attempting to access completely empty heap, no 0 index");
-    }
-    if (container.size() == 1) // if the heap is empty
+    if (container.empty())
     {
-        throw std::invalid_argument("Attempting to access size 1 heap, index 0 exists");
+        throw std::invalid_argument("Attempting to access empty heap");
     }
-    return container.at(1);
+    return container.front();
 }
 
 template <class Container, class Compare=std::less<typename Container::value_type>>
 void heap_delete_min(Container* container, Compare comp=std::less<typename Container::value_type>{})
 {
-    if (container->empty()) // completely empty heap
-    {
-        throw std::invalid_argument("Attempting to delete from completely empty heap, no 0 index");
-    }
-    if (container->size() == 1) // heap has size 1
-    {
-        throw std::invalid_argument("Attempting to delete from size 1 heap, index 0 exists");
-    }
-    if (container->size()-1 == 1) // only 1 element
+    if (container->empty())
     {
-        container->pop_back();
-        return;
+        throw std::invalid_argument("Attempting to delete from empty heap");
     }
-    container->at(1) = container->at(container->size() - 1);
+    heap_pop(container->begin(), container->end(), comp);
     container->pop_back();
-    percolateDown(1, container, comp);
 }
 
 
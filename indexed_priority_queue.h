@@ -0,0 +1,225 @@
+#ifndef INDEXED_PRIORITY_QUEUE_H
+#define INDEXED_PRIORITY_QUEUE_H
+
+#include <cstddef>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// Priority queue whose entries can be found again after they were pushed.
+// push() hands back a handle, and a position map from handle to heap slot lets
+// decrease_key, increase_key and erase fix up a single entry in O(log n).
+// A handle is released when its entry is popped or erased, and later pushes may reuse it.
+// Same ordering as PriorityQueue: comp(a, b) means a comes out first.
+template <class Comparable, class Compare=std::less<Comparable>, size_t Arity=2>
+class IndexedPriorityQueue {
+    static_assert(Arity >= 2, "a heap needs at least two children per node");
+
+    public:
+        using handle_type = size_t;
+        static constexpr size_t npos = static_cast<size_t>(-1);
+
+    private:
+        struct Entry {
+            Comparable key;
+            handle_type handle;
+        };
+        Compare compare;
+        std::vector<Entry> heap; // stored from index 0
+        std::vector<size_t> position; // handle -> index in heap, npos when released
+        std::vector<handle_type> freeHandles;
+
+    public:
+        IndexedPriorityQueue() : compare(), heap(), position(), freeHandles() {}
+        explicit IndexedPriorityQueue(const Compare& comp) : compare(comp), heap(), position(), freeHandles() {}
+
+        bool empty() const {
+            return heap.empty();
+        }
+        size_t size() const {
+            return heap.size();
+        }
+        void reserve(size_t n) {
+            heap.reserve(n);
+            position.reserve(n);
+        }
+        void clear() {
+            heap.clear();
+            position.clear();
+            freeHandles.clear();
+        }
+        bool contains(handle_type handle) const {
+            return handle < position.size() && position[handle] != npos;
+        }
+
+        handle_type push(const Comparable& key) {
+            return emplaceEntry(key);
+        }
+        handle_type push(Comparable&& key) {
+            return emplaceEntry(std::move(key));
+        }
+
+        const Comparable& top() const {
+            if (heap.empty())
+            {
+                throw std::out_of_range("");
+            }
+            return heap.front().key;
+        }
+        handle_type top_handle() const {
+            if (heap.empty())
+            {
+                throw std::out_of_range("");
+            }
+            return heap.front().handle;
+        }
+        const Comparable& key(handle_type handle) const {
+            return heap[checkedPosition(handle)].key;
+        }
+
+        void pop() {
+            if (heap.empty())
+            {
+                throw std::out_of_range("");
+            }
+            removeAt(0);
+        }
+        void erase(handle_type handle) {
+            removeAt(checkedPosition(handle));
+        }
+
+        // The new key may not come out later than the current one.
+        void decrease_key(handle_type handle, const Comparable& newKey) {
+            size_t index = checkedPosition(handle);
+            if (compare(heap[index].key, newKey))
+            {
+                throw std::invalid_argument("decrease_key would move the entry down");
+            }
+            heap[index].key = newKey;
+            siftUp(index);
+        }
+        // The new key may not come out earlier than the current one.
+        void increase_key(handle_type handle, const Comparable& newKey) {
+            size_t index = checkedPosition(handle);
+            if (compare(newKey, heap[index].key))
+            {
+                throw std::invalid_argument("increase_key would move the entry up");
+            }
+            heap[index].key = newKey;
+            siftDown(index);
+        }
+        // Either direction.
+        void update(handle_type handle, const Comparable& newKey) {
+            size_t index = checkedPosition(handle);
+            heap[index].key = newKey;
+            siftDown(siftUp(index));
+        }
+
+        void print_queue(std::ostream& os =std::cout) const {
+            if (heap.empty())
+            {
+                os << "<empty>\n";
+                return;
+            }
+            os << heap[0].key;
+            for (size_t i = 1; i < heap.size(); i++)
+            {
+                os << ", " << heap[i].key;
+            }
+            os << "\n";
+        }
+
+    private:
+        size_t checkedPosition(handle_type handle) const {
+            if (!contains(handle))
+            {
+                throw std::out_of_range("");
+            }
+            return position[handle];
+        }
+
+        template <class K>
+        handle_type emplaceEntry(K&& key) {
+            handle_type handle;
+            if (!freeHandles.empty())
+            {
+                handle = freeHandles.back();
+                freeHandles.pop_back();
+            }
+            else
+            {
+                handle = position.size();
+                position.push_back(npos);
+            }
+            heap.push_back(Entry{std::forward<K>(key), handle});
+            position[handle] = heap.size() - 1;
+            siftUp(heap.size() - 1);
+            return handle;
+        }
+
+        void removeAt(size_t index) {
+            handle_type handle = heap[index].handle;
+            position[handle] = npos;
+            freeHandles.push_back(handle);
+            if (index != heap.size() - 1)
+            {
+                heap[index] = std::move(heap.back());
+                heap.pop_back();
+                position[heap[index].handle] = index;
+                siftDown(siftUp(index));
+            }
+            else
+            {
+                heap.pop_back();
+            }
+        }
+
+        // Hole technique as in heap.h, the position map is updated once per move.
+        size_t siftUp(size_t holeIndex) {
+            Entry entry = std::move(heap[holeIndex]);
+            while (holeIndex > 0)
+            {
+                size_t parentIndex = (holeIndex - 1) / Arity;
+                if (!compare(entry.key, heap[parentIndex].key))
+                {
+                    break;
+                }
+                heap[holeIndex] = std::move(heap[parentIndex]);
+                position[heap[holeIndex].handle] = holeIndex;
+                holeIndex = parentIndex;
+            }
+            position[entry.handle] = holeIndex;
+            heap[holeIndex] = std::move(entry);
+            return holeIndex;
+        }
+        size_t siftDown(size_t holeIndex) {
+            Entry entry = std::move(heap[holeIndex]);
+            size_t size = heap.size();
+            size_t childIndex;
+            while ((childIndex = holeIndex * Arity + 1) < size)
+            {
+                size_t lastChild = childIndex + Arity < size ? childIndex + Arity : size;
+                for (size_t sibling = childIndex + 1; sibling < lastChild; sibling++)
+                {
+                    if (compare(heap[sibling].key, heap[childIndex].key))
+                    {
+                        childIndex = sibling;
+                    }
+                }
+                if (!compare(heap[childIndex].key, entry.key))
+                {
+                    break;
+                }
+                heap[holeIndex] = std::move(heap[childIndex]);
+                position[heap[holeIndex].handle] = holeIndex;
+                holeIndex = childIndex;
+            }
+            position[entry.handle] = holeIndex;
+            heap[holeIndex] = std::move(entry);
+            return holeIndex;
+        }
+};
+
+#endif  // INDEXED_PRIORITY_QUEUE_H
@@ -0,0 +1,283 @@
+#ifndef MPMC_QUEUE_H
+#define MPMC_QUEUE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Bounded lock-free queue for any number of producer and consumer threads.
+// Every slot carries a sequence number that says whose turn it is: a producer may fill
+// slot pos when its sequence is pos, a consumer may empty it when it is pos + 1.
+// Threads only contend on the enqueue or dequeue position with a single CAS.
+// enqueue/dequeue block on a condition variable instead of spinning; the lock is
+// only touched when some thread is actually asleep.
+template <typename Object, class Allocator = std::allocator<Object>>
+class MpmcQueue {
+    private:
+        static_assert(std::is_nothrow_move_constructible_v<Object>, "MpmcQueue needs a nothrow move constructor");
+
+        static constexpr size_t CacheLine = 64;
+
+        struct Cell {
+            std::atomic<size_t> sequence;
+            alignas(Object) unsigned char storage[sizeof(Object)];
+
+            Object* object() {
+                return std::launder(reinterpret_cast<Object*>(storage));
+            }
+        };
+        using AllocTraits = std::allocator_traits<Allocator>;
+        using CellAllocator = typename AllocTraits::template rebind_alloc<Cell>;
+        using CellTraits = std::allocator_traits<CellAllocator>;
+
+        // Set at construction, read-only afterwards
+        Allocator alloc;
+        Cell* cells;
+        size_t _capacity;
+        size_t mask;
+
+        alignas(CacheLine) std::atomic<size_t> enqueuePos;
+        alignas(CacheLine) std::atomic<size_t> dequeuePos;
+
+        // Only used by the blocking calls
+        alignas(CacheLine) std::mutex waitLock;
+        std::condition_variable notFull;
+        std::condition_variable notEmpty;
+        std::atomic<size_t> waitingProducers;
+        std::atomic<size_t> waitingConsumers;
+
+    public:
+        using allocator_type = Allocator;
+
+        // Capacity is rounded up to a power of two, and is at least 2.
+        explicit MpmcQueue(size_t capacity, const Allocator& allocator = Allocator())
+            : alloc(allocator), cells(nullptr), _capacity(roundUpPowerOfTwo(capacity)), mask(_capacity - 1),
+              enqueuePos(0), dequeuePos(0), waitingProducers(0), waitingConsumers(0)
+        {
+            CellAllocator cellAlloc(alloc);
+            cells = CellTraits::allocate(cellAlloc, _capacity);
+            for (size_t i = 0; i < _capacity; i++)
+            {
+                CellTraits::construct(cellAlloc, cells + i);
+                cells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+        MpmcQueue(const MpmcQueue& other) = delete;
+        MpmcQueue& operator=(const MpmcQueue& other) = delete;
+        ~MpmcQueue() {
+            size_t pos = dequeuePos.load(std::memory_order_relaxed);
+            size_t end = enqueuePos.load(std::memory_order_relaxed);
+            for (; pos != end; pos++)
+            {
+                AllocTraits::destroy(alloc, cells[pos & mask].object());
+            }
+            CellAllocator cellAlloc(alloc);
+            for (size_t i = 0; i < _capacity; i++)
+            {
+                CellTraits::destroy(cellAlloc, cells + i);
+            }
+            CellTraits::deallocate(cellAlloc, cells, _capacity);
+        }
+
+        Allocator get_allocator() const {
+            return alloc;
+        }
+
+        // If constructing from args can throw, the element is built before a slot is claimed,
+        // so rvalue args are consumed even when this returns false.
+        template <class... Args>
+        bool try_emplace(Args&&... args) {
+            if constexpr (std::is_nothrow_constructible_v<Object, Args&&...>)
+            {
+                return published(tryPublish(std::forward<Args>(args)...));
+            }
+            else
+            {
+                Object temp(std::forward<Args>(args)...);
+                return published(tryPublish(std::move(temp)));
+            }
+        }
+        bool try_enqueue(const Object& other) {
+            return try_emplace(other);
+        }
+        // other is left untouched when the queue is full.
+        bool try_enqueue(Object&& other) {
+            return published(tryPublish(std::move(other)));
+        }
+        // Blocks while the queue is full.
+        void enqueue(const Object& other) {
+            if constexpr (std::is_nothrow_copy_constructible_v<Object>)
+            {
+                waitUntil(notFull, waitingProducers, [&] { return tryPublish(other); });
+                published(true);
+            }
+            else
+            {
+                Object temp(other);
+                enqueue(std::move(temp));
+            }
+        }
+        void enqueue(Object&& other) {
+            waitUntil(notFull, waitingProducers, [&] { return tryPublish(std::move(other)); });
+            published(true);
+        }
+
+        bool try_dequeue(Object& out) {
+            alignas(Object) unsigned char storage[sizeof(Object)];
+            Object* taken = reinterpret_cast<Object*>(storage);
+            if (!tryTake(taken))
+            {
+                return false;
+            }
+            wake(notFull, waitingProducers);
+            Holder first(taken);
+            out = std::move(*taken);
+            return true;
+        }
+        // Blocks while the queue is empty.
+        Object dequeue() {
+            alignas(Object) unsigned char storage[sizeof(Object)];
+            Object* out = reinterpret_cast<Object*>(storage);
+            waitUntil(notEmpty, waitingConsumers, [&] { return tryTake(out); });
+            wake(notFull, waitingProducers);
+            Holder taken(out);
+            return std::move(*out);
+        }
+
+        // Only a snapshot while other threads are running.
+        size_t size() const {
+            size_t head = dequeuePos.load(std::memory_order_acquire);
+            size_t tail = enqueuePos.load(std::memory_order_acquire);
+            return tail > head ? tail - head : 0;
+        }
+        bool empty() const {
+            return size() == 0;
+        }
+        size_t capacity() const {
+            return _capacity;
+        }
+
+    private:
+        // Destroys an element that was moved out of its slot into local storage.
+        struct Holder {
+            Object* object;
+            explicit Holder(Object* o) : object(o) {}
+            ~Holder() {
+                object->~Object();
+            }
+        };
+
+        static size_t roundUpPowerOfTwo(size_t n) {
+            size_t capacity = 2;
+            while (capacity < n)
+            {
+                capacity *= 2;
+            }
+            return capacity;
+        }
+        bool published(bool done) {
+            if (done)
+            {
+                wake(notEmpty, waitingConsumers);
+            }
+            return done;
+        }
+
+        // Claims the next slot and constructs the element in it; args must not throw.
+        // Does not wake anyone, it may run under waitLock.
+        template <class... Args>
+        bool tryPublish(Args&&... args) {
+            size_t pos = enqueuePos.load(std::memory_order_relaxed);
+            Cell* cell;
+            for (;;)
+            {
+                cell = &cells[pos & mask];
+                size_t seq = cell->sequence.load(std::memory_order_acquire);
+                std::ptrdiff_t diff = (std::ptrdiff_t) seq - (std::ptrdiff_t) pos;
+                if (diff == 0)
+                {
+                    if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    {
+                        break;
+                    }
+                }
+                else if (diff < 0)
+                {
+                    return false; // full
+                }
+                else
+                {
+                    pos = enqueuePos.load(std::memory_order_relaxed);
+                }
+            }
+            AllocTraits::construct(alloc, cell->object(), std::forward<Args>(args)...);
+            cell->sequence.store(pos + 1, std::memory_order_release);
+            return true;
+        }
+        // Moves the front element into the raw storage at out, without waking anyone.
+        // The nothrow move means a claimed slot is always handed back.
+        bool tryTake(Object* out) {
+            size_t pos = dequeuePos.load(std::memory_order_relaxed);
+            Cell* cell;
+            for (;;)
+            {
+                cell = &cells[pos & mask];
+                size_t seq = cell->sequence.load(std::memory_order_acquire);
+                std::ptrdiff_t diff = (std::ptrdiff_t) seq - (std::ptrdiff_t) (pos + 1);
+                if (diff == 0)
+                {
+                    if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    {
+                        break;
+                    }
+                }
+                else if (diff < 0)
+                {
+                    return false;
+                }
+                else
+                {
+                    pos = dequeuePos.load(std::memory_order_relaxed);
+                }
+            }
+            ::new (static_cast<void*>(out)) Object(std::move(*cell->object()));
+            AllocTraits::destroy(alloc, cell->object());
+            cell->sequence.store(pos + mask + 1, std::memory_order_release);
+            return true;
+        }
+
+        // The waiter bumps its counter before retrying and the other side publishes before
+        // reading it, with a full fence on both sides, so either the retry sees the new
+        // state or the other side sees the waiter and takes the lock to notify it.
+        // The caller wakes the opposite side once this returns and the lock is released.
+        template <class Attempt>
+        void waitUntil(std::condition_variable& cv, std::atomic<size_t>& waiting, Attempt attempt) {
+            if (attempt())
+            {
+                return;
+            }
+            std::unique_lock<std::mutex> guard(waitLock);
+            waiting.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            while (!attempt())
+            {
+                cv.wait(guard);
+            }
+            waiting.fetch_sub(1, std::memory_order_relaxed);
+        }
+        void wake(std::condition_variable& cv, std::atomic<size_t>& waiting) {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (waiting.load(std::memory_order_relaxed) != 0)
+            {
+                std::lock_guard<std::mutex> guard(waitLock);
+                cv.notify_one();
+            }
+        }
+};
+
+#endif  // MPMC_QUEUE_H
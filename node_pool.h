@@ -0,0 +1,353 @@
+#ifndef NODE_POOL_H
+#define NODE_POOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+
+// Set to 0 to make every allocation go straight to the shared pool under its lock.
+#ifndef NODE_POOL_THREAD_CACHE
+#define NODE_POOL_THREAD_CACHE 1
+#endif
+
+// Fixed size block allocator. Blocks are carved out of big slabs and recycled
+// through a free list, slabs only go back to the system when the pool is destroyed.
+class NodePool {
+    private:
+        struct FreeBlock {
+            FreeBlock* next;
+        };
+        struct Slab {
+            Slab* next;
+        };
+        size_t _blockSize;
+        size_t _blockAlign;
+        size_t _blocksPerSlab;
+        FreeBlock* freeList; // recycled blocks
+        FreeBlock* unusedList; // blocks thread caches gave back without handing them out
+        Slab* slabs;
+        char* carveNext; // untouched part of the newest slab
+        char* carveEnd;
+        size_t slabCount;
+        size_t allocations; // every block handed out, including ones served by thread caches
+        size_t carved; // blocks handed out for the first time
+        mutable std::mutex lock;
+    public:
+        explicit NodePool(size_t blockSize, size_t blockAlign = alignof(std::max_align_t), size_t blocksPerSlab = 256)
+            : _blockSize(0), _blockAlign(blockAlign < alignof(FreeBlock) ? alignof(FreeBlock) : blockAlign),
+              _blocksPerSlab(blocksPerSlab == 0 ? 1 : blocksPerSlab), freeList(nullptr), unusedList(nullptr), slabs(nullptr),
+              carveNext(nullptr), carveEnd(nullptr), slabCount(0), allocations(0), carved(0)
+        {
+            // every block has to hold a free list link and keep the next block aligned
+            size_t size = blockSize < sizeof(FreeBlock) ? sizeof(FreeBlock) : blockSize;
+            _blockSize = (size + _blockAlign - 1) / _blockAlign * _blockAlign;
+        }
+        NodePool(const NodePool& other) = delete;
+        NodePool& operator=(const NodePool& other) = delete;
+        ~NodePool()
+        {
+            while (slabs != nullptr)
+            {
+                Slab* next = slabs->next;
+                ::operator delete(static_cast<void*>(slabs), std::align_val_t(_blockAlign));
+                slabs = next;
+            }
+        }
+
+        void* allocate()
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            allocations++;
+            void* block = takeBlock();
+            if (is_unused(block))
+            {
+                carved++;
+                block = mark_used(block);
+            }
+            return block;
+        }
+
+        void deallocate(void* block)
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            giveBlock(block);
+        }
+
+        // Batched versions used by the thread caches so they only take the lock once per batch.
+        // Allocations made out of a cache are reported through servedFromCache, firstUses of
+        // them were blocks handed out for the first time. Blocks the pool has never handed
+        // out carry the is_unused mark while they sit in a cache.
+        void allocate_batch(void** out, size_t count, size_t servedFromCache, size_t firstUses)
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            allocations += servedFromCache;
+            carved += firstUses;
+            for (size_t i = 0; i < count; i++)
+            {
+                out[i] = takeBlock();
+            }
+        }
+
+        void deallocate_batch(void** blocks, size_t count, size_t servedFromCache, size_t firstUses)
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            allocations += servedFromCache;
+            carved += firstUses;
+            for (size_t i = 0; i < count; i++)
+            {
+                giveBlock(blocks[i]);
+            }
+        }
+
+        // Allocations a thread cache served out of blocks it already held.
+        void report_allocations(size_t servedFromCache, size_t firstUses)
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            allocations += servedFromCache;
+            carved += firstUses;
+        }
+
+        // Blocks are aligned to at least a pointer, so the low bit is free for the mark.
+        static bool is_unused(void* block)
+        {
+            return (reinterpret_cast<uintptr_t>(block) & 1) != 0;
+        }
+
+        static void* mark_used(void* block)
+        {
+            return reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(block) & ~(uintptr_t) 1);
+        }
+
+        size_t block_size() const {
+            return _blockSize;
+        }
+
+        size_t slab_count() const {
+            std::lock_guard<std::mutex> guard(lock);
+            return slabCount;
+        }
+
+        size_t allocation_count() const {
+            std::lock_guard<std::mutex> guard(lock);
+            return allocations;
+        }
+
+        // Thread caches report every few dozen allocations, so while threads are running the
+        // counters can be behind by up to that many per thread.
+        size_t reuse_count() const {
+            std::lock_guard<std::mutex> guard(lock);
+            return allocations > carved ? allocations - carved : 0;
+        }
+
+        double reuse_rate() const {
+            std::lock_guard<std::mutex> guard(lock);
+            if (allocations == 0 || carved >= allocations)
+            {
+                return 0;
+            }
+            return (double) (allocations - carved) / allocations;
+        }
+
+    private:
+        // Recycled blocks come first; a block never handed out before comes back marked.
+        void* takeBlock()
+        {
+            if (freeList != nullptr)
+            {
+                FreeBlock* block = freeList;
+                freeList = block->next;
+                return block;
+            }
+            void* block;
+            if (unusedList != nullptr)
+            {
+                block = unusedList;
+                unusedList = unusedList->next;
+            }
+            else
+            {
+                if (carveNext == carveEnd)
+                {
+                    addSlab();
+                }
+                block = carveNext;
+                carveNext += _blockSize;
+            }
+            return reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(block) | 1);
+        }
+
+        void giveBlock(void* block)
+        {
+            FreeBlock*& list = is_unused(block) ? unusedList : freeList;
+            FreeBlock* freed = static_cast<FreeBlock*>(mark_used(block));
+            freed->next = list;
+            list = freed;
+        }
+
+        void addSlab()
+        {
+            // the first block of every slab holds the link to the previous slab
+            char* memory = static_cast<char*>(::operator new(_blockSize * (_blocksPerSlab + 1), std::align_val_t(_blockAlign)));
+            Slab* slab = reinterpret_cast<Slab*>(memory);
+            slab->next = slabs;
+            slabs = slab;
+            carveNext = memory + _blockSize;
+            carveEnd = carveNext + _blockSize * _blocksPerSlab;
+            slabCount++;
+        }
+};
+
+// One process wide pool per block shape, fronted by a small per thread cache.
+template <size_t Size, size_t Align>
+class SharedNodePool {
+    private:
+        static constexpr size_t CacheCapacity = 64;
+        static constexpr size_t CacheBatch = 32;
+        static constexpr size_t ReportInterval = 32;
+
+        // Trivially destructible so it stays usable while other thread locals are torn down.
+        struct Cache {
+            void* blocks[CacheCapacity];
+            size_t count;
+            size_t served; // allocations not yet reported to the pool
+            size_t firstUses; // how many of those were blocks never handed out before
+            bool registered;
+            bool closed;
+        };
+        struct CacheFlusher {
+            ~CacheFlusher()
+            {
+                Cache& c = cache;
+                pool().deallocate_batch(c.blocks, c.count, c.served, c.firstUses);
+                c.count = 0;
+                c.served = 0;
+                c.firstUses = 0;
+                c.closed = true;
+            }
+        };
+        static inline thread_local Cache cache{};
+        static inline thread_local CacheFlusher flusher;
+
+    public:
+        // Never destroyed, containers with static storage may still free nodes at exit.
+        static NodePool& pool()
+        {
+            static NodePool* shared = new NodePool(Size, Align);
+            return *shared;
+        }
+
+        static void* allocate()
+        {
+#if NODE_POOL_THREAD_CACHE
+            Cache& c = cache;
+            if (!c.closed)
+            {
+                if (c.count == 0)
+                {
+                    if (!c.registered)
+                    {
+                        c.registered = true;
+                        (void) &flusher; // first use sets up the flush at thread exit
+                    }
+                    pool().allocate_batch(c.blocks, CacheBatch, c.served, c.firstUses);
+                    c.count = CacheBatch;
+                    c.served = 0;
+                    c.firstUses = 0;
+                }
+                void* block = c.blocks[--c.count];
+                if (NodePool::is_unused(block))
+                {
+                    c.firstUses++;
+                    block = NodePool::mark_used(block);
+                }
+                if (++c.served == ReportInterval)
+                {
+                    pool().report_allocations(c.served, c.firstUses);
+                    c.served = 0;
+                    c.firstUses = 0;
+                }
+                return block;
+            }
+#endif
+            return pool().allocate();
+        }
+
+        static void deallocate(void* block)
+        {
+#if NODE_POOL_THREAD_CACHE
+            Cache& c = cache;
+            if (!c.closed)
+            {
+                if (c.count == CacheCapacity)
+                {
+                    // hand the older half back so other threads can reuse it
+                    pool().deallocate_batch(c.blocks, CacheBatch, c.served, c.firstUses);
+                    for (size_t i = CacheBatch; i < CacheCapacity; i++)
+                    {
+                        c.blocks[i - CacheBatch] = c.blocks[i];
+                    }
+                    c.count -= CacheBatch;
+                    c.served = 0;
+                    c.firstUses = 0;
+                }
+                c.blocks[c.count++] = block;
+                return;
+            }
+#endif
+            pool().deallocate(block);
+        }
+};
+
+// Allocator that serves single objects from the shared pool for their size and
+// alignment. Array allocations (n > 1) fall back to std::allocator.
+template <class T>
+class PoolAllocator {
+    public:
+        using value_type = T;
+        using is_always_equal = std::true_type;
+        using propagate_on_container_move_assignment = std::true_type;
+
+        PoolAllocator() noexcept {}
+        template <class U>
+        PoolAllocator(const PoolAllocator<U>&) noexcept {}
+
+        T* allocate(size_t n)
+        {
+            if (n == 1)
+            {
+                return static_cast<T*>(SharedNodePool<sizeof(T), alignof(T)>::allocate());
+            }
+            return std::allocator<T>().allocate(n);
+        }
+
+        void deallocate(T* p, size_t n)
+        {
+            if (n == 1)
+            {
+                SharedNodePool<sizeof(T), alignof(T)>::deallocate(p);
+                return;
+            }
+            std::allocator<T>().deallocate(p, n);
+        }
+
+        // The pool backing this allocator, for its slab and reuse counters.
+        static const NodePool& pool()
+        {
+            return SharedNodePool<sizeof(T), alignof(T)>::pool();
+        }
+};
+
+template <class T, class U>
+bool operator==(const PoolAllocator<T>&, const PoolAllocator<U>&) noexcept {
+    return true;
+}
+
+template <class T, class U>
+bool operator!=(const PoolAllocator<T>&, const PoolAllocator<U>&) noexcept {
+    return false;
+}
+
+#endif  // NODE_POOL_H
@@ -0,0 +1,382 @@
+#ifndef PAIRING_HEAP_H
+#define PAIRING_HEAP_H
+
+#include "node_pool.h"
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// Pairing heap: a heap ordered multiway tree where push, meld and decrease_key just
+// link two trees in O(1) and pop does the real work, O(log n) amortized, by pairing up
+// the children of the old root. push() returns a handle to the element for
+// decrease_key and erase; it stays valid until that element is popped or erased.
+// Same ordering as PriorityQueue: comp(a, b) means a comes out first.
+template <class Comparable, class Compare=std::less<Comparable>, class Allocator=PoolAllocator<Comparable>>
+class PairingHeap {
+    private:
+        struct Node {
+            Comparable data;
+            Node* child; // leftmost child
+            Node* sibling; // next sibling to the right
+            Node* prev; // left sibling, or the parent for a leftmost child
+
+            template <class... Args>
+            explicit Node(std::in_place_t, Args&&... args)
+                : data(std::forward<Args>(args)...), child(nullptr), sibling(nullptr), prev(nullptr) {}
+        };
+        using NodeAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Node>;
+        using NodeTraits = std::allocator_traits<NodeAllocator>;
+
+        Compare compare;
+        NodeAllocator nodeAlloc;
+        Node* root;
+        size_t _size;
+
+    public:
+        using allocator_type = Allocator;
+
+        class handle {
+            Node* node;
+            friend class PairingHeap;
+            explicit handle(Node* n) : node(n) {}
+            public:
+                handle() : node(nullptr) {}
+                bool operator==(const handle& other) const {
+                    return node == other.node;
+                }
+                bool operator!=(const handle& other) const {
+                    return node != other.node;
+                }
+        };
+
+        PairingHeap() : compare(), nodeAlloc(), root(nullptr), _size(0) {}
+        explicit PairingHeap(const Compare& comp, const Allocator& alloc = Allocator())
+            : compare(comp), nodeAlloc(alloc), root(nullptr), _size(0) {}
+        explicit PairingHeap(const Allocator& alloc) : compare(), nodeAlloc(alloc), root(nullptr), _size(0) {}
+        PairingHeap(const PairingHeap& other)
+            : compare(other.compare), nodeAlloc(NodeTraits::select_on_container_copy_construction(other.nodeAlloc)),
+              root(nullptr), _size(0)
+        {
+            copyFrom(other);
+        }
+        PairingHeap(PairingHeap&& other) noexcept
+            : compare(std::move(other.compare)), nodeAlloc(std::move(other.nodeAlloc)), root(other.root), _size(other._size)
+        {
+            other.root = nullptr;
+            other._size = 0;
+        }
+        ~PairingHeap() {
+            clear();
+        }
+        PairingHeap& operator=(const PairingHeap& other) {
+            if (this == &other)
+            {
+                return *this;
+            }
+            clear();
+            compare = other.compare;
+            if constexpr (NodeTraits::propagate_on_container_copy_assignment::value)
+            {
+                nodeAlloc = other.nodeAlloc;
+            }
+            copyFrom(other);
+            return *this;
+        }
+        PairingHeap& operator=(PairingHeap&& other) {
+            if (this == &other)
+            {
+                return *this;
+            }
+            clear();
+            compare = std::move(other.compare);
+            if constexpr (NodeTraits::propagate_on_container_move_assignment::value)
+            {
+                nodeAlloc = std::move(other.nodeAlloc);
+            }
+            else if (nodeAlloc != other.nodeAlloc)
+            {
+                copyFrom(other);
+                other.clear();
+                return *this;
+            }
+            root = other.root;
+            _size = other._size;
+            other.root = nullptr;
+            other._size = 0;
+            return *this;
+        }
+
+        Allocator get_allocator() const {
+            return Allocator(nodeAlloc);
+        }
+        bool empty() const {
+            return root == nullptr;
+        }
+        size_t size() const {
+            return _size;
+        }
+
+        const Comparable& top() const {
+            if (root == nullptr)
+            {
+                throw std::out_of_range("");
+            }
+            return root->data;
+        }
+        handle top_handle() const {
+            if (root == nullptr)
+            {
+                throw std::out_of_range("");
+            }
+            return handle(root);
+        }
+        const Comparable& key(handle h) const {
+            return h.node->data;
+        }
+
+        handle push(const Comparable& value) {
+            return emplace(value);
+        }
+        handle push(Comparable&& value) {
+            return emplace(std::move(value));
+        }
+        template <class... Args>
+        handle emplace(Args&&... args) {
+            Node* node = createNode(std::forward<Args>(args)...);
+            root = root == nullptr ? node : link(root, node);
+            _size++;
+            return handle(node);
+        }
+
+        void pop() {
+            if (root == nullptr)
+            {
+                throw std::out_of_range("");
+            }
+            Node* old = root;
+            root = combineSiblings(old->child);
+            destroyNode(old);
+            _size--;
+        }
+
+        // The new key may not come out later than the current one.
+        void decrease_key(handle h, const Comparable& newKey) {
+            Node* node = h.node;
+            if (compare(node->data, newKey))
+            {
+                throw std::invalid_argument("decrease_key would move the entry down");
+            }
+            node->data = newKey;
+            if (node != root)
+            {
+                cut(node);
+                root = link(root, node);
+            }
+        }
+
+        void erase(handle h) {
+            Node* node = h.node;
+            if (node == root)
+            {
+                pop();
+                return;
+            }
+            cut(node);
+            Node* children = combineSiblings(node->child);
+            destroyNode(node);
+            _size--;
+            if (children != nullptr)
+            {
+                root = link(root, children);
+            }
+        }
+
+        // Takes every element of other in O(1); handles into other stay valid here.
+        void meld(PairingHeap&& other) {
+            if (this == &other || other.root == nullptr)
+            {
+                return;
+            }
+            if constexpr (!NodeTraits::is_always_equal::value)
+            {
+                if (nodeAlloc != other.nodeAlloc)
+                {
+                    throw std::invalid_argument("meld needs equal allocators");
+                }
+            }
+            root = root == nullptr ? other.root : link(root, other.root);
+            _size += other._size;
+            other.root = nullptr;
+            other._size = 0;
+        }
+
+        void clear() {
+            // walk the tree without recursion by splicing every child list into a work list
+            Node* work = root;
+            while (work != nullptr)
+            {
+                Node* node = work;
+                work = node->sibling;
+                if (node->child != nullptr)
+                {
+                    Node* last = node->child;
+                    while (last->sibling != nullptr)
+                    {
+                        last = last->sibling;
+                    }
+                    last->sibling = work;
+                    work = node->child;
+                }
+                destroyNode(node);
+            }
+            root = nullptr;
+            _size = 0;
+        }
+
+    private:
+        template <class... Args>
+        Node* createNode(Args&&... args) {
+            Node* node = NodeTraits::allocate(nodeAlloc, 1);
+            try
+            {
+                NodeTraits::construct(nodeAlloc, node, std::in_place, std::forward<Args>(args)...);
+            }
+            catch (...)
+            {
+                NodeTraits::deallocate(nodeAlloc, node, 1);
+                throw;
+            }
+            return node;
+        }
+        void destroyNode(Node* node) {
+            NodeTraits::destroy(nodeAlloc, node);
+            NodeTraits::deallocate(nodeAlloc, node, 1);
+        }
+
+        // Links two roots, the loser becomes the leftmost child of the winner.
+        Node* link(Node* a, Node* b) {
+            if (compare(b->data, a->data))
+            {
+                std::swap(a, b);
+            }
+            b->prev = a;
+            b->sibling = a->child;
+            if (a->child != nullptr)
+            {
+                a->child->prev = b;
+            }
+            a->child = b;
+            a->sibling = nullptr;
+            a->prev = nullptr;
+            return a;
+        }
+
+        // Detaches the subtree rooted at node from its parent and siblings.
+        void cut(Node* node) {
+            if (node->prev->child == node)
+            {
+                node->prev->child = node->sibling;
+            }
+            else
+            {
+                node->prev->sibling = node->sibling;
+            }
+            if (node->sibling != nullptr)
+            {
+                node->sibling->prev = node->prev;
+            }
+            node->sibling = nullptr;
+            node->prev = nullptr;
+        }
+
+        // Two pass pairing: link neighbours left to right, then fold the pairs right to left.
+        Node* combineSiblings(Node* first) {
+            if (first == nullptr)
+            {
+                return nullptr;
+            }
+            Node* pairs = nullptr; // linked through sibling, last pair first
+            while (first != nullptr)
+            {
+                Node* a = first;
+                Node* b = a->sibling;
+                if (b == nullptr)
+                {
+                    a->prev = nullptr;
+                    a->sibling = pairs;
+                    pairs = a;
+                    break;
+                }
+                first = b->sibling;
+                Node* merged = link(a, b);
+                merged->sibling = pairs;
+                pairs = merged;
+            }
+            Node* result = pairs;
+            pairs = pairs->sibling;
+            result->sibling = nullptr;
+            while (pairs != nullptr)
+            {
+                Node* next = pairs->sibling;
+                result = link(pairs, result);
+                pairs = next;
+            }
+            return result;
+        }
+
+        // Clones the tree shape iteratively, a sibling chain can be as long as the heap.
+        void copyFrom(const PairingHeap& other) {
+            if (other.root == nullptr)
+            {
+                return;
+            }
+            root = createNode(other.root->data);
+            _size = 1;
+            std::vector<std::pair<const Node*, Node*>> work; // source node, its copy
+            work.push_back({other.root, root});
+            try
+            {
+                copyChildren(work);
+            }
+            catch (...)
+            {
+                clear(); // every copy made so far is already linked into the tree
+                throw;
+            }
+        }
+        void copyChildren(std::vector<std::pair<const Node*, Node*>>& work) {
+            while (!work.empty())
+            {
+                std::pair<const Node*, Node*> next = work.back();
+                work.pop_back();
+                Node* previous = next.second;
+                bool leftmost = true;
+                for (const Node* child = next.first->child; child != nullptr; child = child->sibling)
+                {
+                    Node* copy = createNode(child->data);
+                    _size++;
+                    copy->prev = previous;
+                    if (leftmost)
+                    {
+                        previous->child = copy;
+                        leftmost = false;
+                    }
+                    else
+                    {
+                        previous->sibling = copy;
+                    }
+                    previous = copy;
+                    work.push_back({child, copy});
+                }
+            }
+        }
+};
+
+template <class Comparable, class Compare=std::less<Comparable>>
+using PmrPairingHeap = PairingHeap<Comparable, Compare, std::pmr::polymorphic_allocator<Comparable>>;
+
+#endif  // PAIRING_HEAP_H
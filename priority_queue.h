@@ -4,29 +4,36 @@
 #include <functional>
 #include <vector>
 #include <iostream>
+#include <iterator>
+#include <utility>
 #include "heap.h"
 
 using std::cout, std::endl;
 
-template <class Comparable, class Container=std::vector<Comparable>, class Compare=std::less<typename Container::value_type>>
+// HeapPolicy picks the heap shape, see DaryHeapPolicy in heap.h.
+template <class Comparable, class Container=std::vector<Comparable>, class Compare=std::less<typename Container::value_type>,
+          class HeapPolicy=BinaryHeapPolicy>
 class PriorityQueue {
     Compare compare; // less than greater than etc
-    Container container; // container
-    size_t _size;
+    Container container; // heap stored from index 0
     public:
-        PriorityQueue<Comparable,Container,Compare>() : compare(), container(), _size(0) {
-            heapify(&container, compare);
+        PriorityQueue() : compare(), container() {}
+        explicit PriorityQueue(const Compare& comp) : compare (comp), container() {}
+        explicit PriorityQueue(const Container& givenContainer) : compare(), container(givenContainer) {
+            HeapPolicy::make(container.begin(), container.end(), compare);
         }
-        explicit PriorityQueue(const Compare& comp) : compare (comp), container(), _size(0) {
-            heapify(&container, compare);
+        PriorityQueue(const Compare& comp, const Container& givenContainer) : compare(comp), container(givenContainer){
+            HeapPolicy::make(container.begin(), container.end(), compare);
         }
-        explicit PriorityQueue(const Container& givenContainer) : compare(), container(givenContainer), _size(givenContainer.size()) {
-            heapify(&container, compare);
+        // Takes over the elements without copying and heapifies them in place, O(n).
+        explicit PriorityQueue(Container&& givenContainer) : compare(), container(std::move(givenContainer)) {
+            HeapPolicy::make(container.begin(), container.end(), compare);
         }
-        PriorityQueue(const Compare& comp, const Container& givenContainer) : compare(comp), container(givenContainer), _size(givenContainer.size()){
-            heapify(&container,compare);
+        PriorityQueue(const Compare& comp, Container&& givenContainer) : compare(comp), container(std::move(givenContainer)) {
+            HeapPolicy::make(container.begin(), container.end(), compare);
         }
-        PriorityQueue(const PriorityQueue& other) : compare(other.compare), container(other.container), _size(other._size) {}
+        PriorityQueue(const PriorityQueue& other) : compare(other.compare), container(other.container) {}
+        PriorityQueue(PriorityQueue&& other) : compare(std::move(other.compare)), container(std::move(other.container)) {}
         PriorityQueue& operator=(const PriorityQueue& other)
         {
             if (this == &other)
@@ -35,7 +42,16 @@ class PriorityQueue {
             }
             compare = other.compare;
             container = other.container;
-            _size = other._size;
+            return *this;
+        }
+        PriorityQueue& operator=(PriorityQueue&& other)
+        {
+            if (this == &other)
+            {
+                return *this;
+            }
+            compare = std::move(other.compare);
+            container = std::move(other.container);
             return *this;
         }
         ~PriorityQueue()
@@ -46,31 +62,65 @@ class PriorityQueue {
             return heap_get_min(container);
         }
         bool empty() const {
-            if (container.size() == 1 || container.empty())
-            {
-                return true;
-            }
-            return false;
+            return container.empty();
         }
         size_t size() const {
-            return _size;
+            return container.size();
         }
-        void make_empty() { // question: does that include the 0th index
-            _size = 0;
+        void make_empty() {
             container.clear();
-            container.push_back(typename Container::value_type());
         }
         void push(const typename Container::value_type& value) {
-            heap_insert(&container,value,compare);
-            _size++;
+            container.push_back(value);
+            HeapPolicy::push(container.begin(), container.end(), compare);
+        }
+        void push(typename Container::value_type&& value) {
+            container.push_back(std::move(value));
+            HeapPolicy::push(container.begin(), container.end(), compare);
+        }
+        template <class... Args>
+        void emplace(Args&&... args) {
+            container.emplace_back(std::forward<Args>(args)...);
+            HeapPolicy::push(container.begin(), container.end(), compare);
+        }
+        // Appends [first, last) and restores the heap, either one push at a time or with a
+        // single O(n) rebuild when the batch is big next to the heap.
+        template <class InputIt>
+        void push_range(InputIt first, InputIt last) {
+            size_t oldSize = container.size();
+            container.insert(container.end(), first, last);
+            size_t added = container.size() - oldSize;
+            if (added >= oldSize / 2)
+            {
+                HeapPolicy::make(container.begin(), container.end(), compare);
+                return;
+            }
+            for (size_t i = oldSize + 1; i <= container.size(); i++)
+            {
+                HeapPolicy::push(container.begin(), container.begin() + i, compare);
+            }
+        }
+        // Moves every element of other in here and leaves other empty, e.g. to combine
+        // per thread queues. The smaller queue is the one that gets moved.
+        void merge(PriorityQueue&& other) {
+            if (this == &other)
+            {
+                return;
+            }
+            if (other.container.size() > container.size())
+            {
+                std::swap(container, other.container);
+            }
+            push_range(std::make_move_iterator(other.container.begin()), std::make_move_iterator(other.container.end()));
+            other.container.clear();
         }
         void pop() {
             if (empty())
             {
                 return;
             }
-            heap_delete_min(&container,compare);
-            _size--;
+            HeapPolicy::pop(container.begin(), container.end(), compare);
+            container.pop_back();
         }
         void print_queue(std::ostream& os =std::cout) const {
             if (empty())
@@ -78,8 +128,8 @@ class PriorityQueue {
                 os << "<empty>\n";
                 return;
             }
-            os << container.at(1);
-            for (size_t i = 2; i < container.size(); i++)
+            os << container.at(0);
+            for (size_t i = 1; i < container.size(); i++)
             {
                 os << ", " << container.at(i);
             }
@@ -87,4 +137,8 @@ class PriorityQueue {
         }
 };
 
+// Priority queue on a D-ary heap; D = 4 or 8 keeps the children of a node on one cache line.
+template <class Comparable, size_t D=4, class Compare=std::less<Comparable>>
+using DaryHeap = PriorityQueue<Comparable, std::vector<Comparable>, Compare, DaryHeapPolicy<D>>;
+
 #endif  // PRIORITY_QUEUE_H
\ No newline at end of file
@@ -1,50 +1,296 @@
 #ifndef QUEUE_H
 #define QUEUE_H
 
-#include "doubly_linked_list.h"
 #include <cstddef>
+#include <cstring>
 #include <iostream>
-#include <stdexcept> 
+#include <memory>
+#include <memory_resource>
+#include <stdexcept>
+#include <type_traits>
 #include <utility>
 
-template <typename Object>
+// FIFO queue over a growable circular buffer. The capacity is always a power of two
+// so wrapping an index is a mask instead of a modulo.
+template <typename Object, class Allocator = std::allocator<Object>>
 class Queue {
     private:
-        DoublyLinkedList<Object> list;
+        using AllocTraits = std::allocator_traits<Allocator>;
+
+        Allocator alloc;
+        Object* buffer; // raw storage, only the _size slots starting at _head are constructed
+        size_t _capacity;
+        size_t _head;
+        size_t _size;
     public:
-        Queue<Object>() : list({}) {}
-        Queue(const Queue& other) : list(other.list) {}
+        using allocator_type = Allocator;
+
+        Queue() : alloc(), buffer(nullptr), _capacity(0), _head(0), _size(0) {}
+        explicit Queue(const Allocator& allocator) : alloc(allocator), buffer(nullptr), _capacity(0), _head(0), _size(0) {}
+        Queue(const Queue& other)
+            : alloc(AllocTraits::select_on_container_copy_construction(other.alloc)), buffer(nullptr), _capacity(0), _head(0), _size(0)
+        {
+            copyFrom(other);
+        }
+        Queue(Queue&& other) noexcept
+            : alloc(std::move(other.alloc)), buffer(other.buffer), _capacity(other._capacity), _head(other._head), _size(other._size)
+        {
+            other.buffer = nullptr;
+            other._capacity = 0;
+            other._head = 0;
+            other._size = 0;
+        }
         ~Queue() {
-            list.clear();
+            clear();
+            deallocate(buffer, _capacity);
         }
         Queue& operator=(const Queue& other) {
             if (this == &other)
             {
                 return *this;
             }
-            list.clear();
-            list = other.list;
+            clear();
+            if constexpr (AllocTraits::propagate_on_container_copy_assignment::value)
+            {
+                if (alloc != other.alloc)
+                {
+                    deallocate(buffer, _capacity);
+                    buffer = nullptr;
+                    _capacity = 0;
+                }
+                alloc = other.alloc;
+            }
+            copyFrom(other);
+            return *this;
+        }
+        Queue& operator=(Queue&& other) noexcept(AllocTraits::propagate_on_container_move_assignment::value
+                                                 || AllocTraits::is_always_equal::value) {
+            if (this == &other)
+            {
+                return *this;
+            }
+            clear();
+            if (!AllocTraits::propagate_on_container_move_assignment::value && alloc != other.alloc)
+            {
+                reserve(other._size);
+                while (!other.empty())
+                {
+                    emplace(other.dequeue());
+                }
+                return *this;
+            }
+            deallocate(buffer, _capacity);
+            if constexpr (AllocTraits::propagate_on_container_move_assignment::value)
+            {
+                alloc = std::move(other.alloc);
+            }
+            buffer = other.buffer;
+            _capacity = other._capacity;
+            _head = other._head;
+            _size = other._size;
+            other.buffer = nullptr;
+            other._capacity = 0;
+            other._head = 0;
+            other._size = 0;
             return *this;
         }
+        Allocator get_allocator() const {
+            return alloc;
+        }
+        size_t size() const {
+            return _size;
+        }
+        bool empty() const {
+            return _size == 0;
+        }
+        size_t capacity() const {
+            return _capacity;
+        }
+        void reserve(size_t newCapacity) {
+            if (newCapacity > _capacity)
+            {
+                reallocate(roundUpPowerOfTwo(newCapacity));
+            }
+        }
+        void clear() {
+            for (size_t i = 0; i < _size; i++)
+            {
+                AllocTraits::destroy(alloc, slot(i));
+            }
+            _head = 0;
+            _size = 0;
+        }
         void enqueue(const Object& other) {
-            list.insert(list.size(),other);
+            emplace(other);
+        }
+        void enqueue(Object&& other) {
+            emplace(std::move(other));
+        }
+        template <class... Args>
+        Object& emplace(Args&&... args) {
+            if (_size == _capacity)
+            {
+                // build the element first, args may refer to something already in the queue
+                Object temp(std::forward<Args>(args)...);
+                reallocate(_capacity == 0 ? 8 : _capacity * 2);
+                AllocTraits::construct(alloc, slot(_size), std::move(temp));
+            }
+            else
+            {
+                AllocTraits::construct(alloc, slot(_size), std::forward<Args>(args)...);
+            }
+            _size++;
+            return *slot(_size - 1);
+        }
+        // Appends count elements with at most one grow and two contiguous copies.
+        void enqueue_n(const Object* values, size_t count) {
+            reserve(_size + count);
+            size_t tail = (_head + _size) & (_capacity - 1);
+            size_t firstPart = _capacity - tail < count ? _capacity - tail : count;
+            constructRange(buffer + tail, values, firstPart);
+            try
+            {
+                constructRange(buffer, values + firstPart, count - firstPart);
+            }
+            catch (...)
+            {
+                destroyRange(buffer + tail, firstPart);
+                throw;
+            }
+            _size += count;
         }
         Object dequeue() {
-            Object first = list[0];
-            list.remove(0);
+            if (_size == 0)
+            {
+                throw std::out_of_range("");
+            }
+            Object first = std::move(*slot(0));
+            popFront();
             return first;
         }
+        bool try_dequeue(Object& out) {
+            if (_size == 0)
+            {
+                return false;
+            }
+            out = std::move(*slot(0));
+            popFront();
+            return true;
+        }
+        // Moves up to count elements into out and returns how many were taken.
+        size_t dequeue_n(Object* out, size_t count) {
+            size_t taken = count < _size ? count : _size;
+            for (size_t i = 0; i < taken; i++)
+            {
+                out[i] = std::move(*slot(0));
+                popFront();
+            }
+            return taken;
+        }
         Object& front() {
-            return list[0];
+            if (_size == 0)
+            {
+                throw std::out_of_range("");
+            }
+            return *slot(0);
+        }
+        const Object& front() const {
+            if (_size == 0)
+            {
+                throw std::out_of_range("");
+            }
+            return *slot(0);
         }
-        void printQueue() {
-            if (list.size() == 0)
+        void printQueue() const {
+            if (_size == 0)
             {
                 std::cout << "Queue empty" << std::endl;
+                return;
+            }
+            for (size_t i = 0; i < _size; i++)
+            {
+                std::cout << "[ " << *slot(i) << " ]" << std::endl;
             }
-            list.printList();
         }
 
+    private:
+        Object* slot(size_t i) const {
+            return buffer + ((_head + i) & (_capacity - 1));
+        }
+        static size_t roundUpPowerOfTwo(size_t n) {
+            size_t capacity = 1;
+            while (capacity < n)
+            {
+                capacity *= 2;
+            }
+            return capacity;
+        }
+        Object* allocate(size_t n) {
+            return AllocTraits::allocate(alloc, n);
+        }
+        void deallocate(Object* p, size_t n) {
+            if (p != nullptr)
+            {
+                AllocTraits::deallocate(alloc, p, n);
+            }
+        }
+        void popFront() {
+            AllocTraits::destroy(alloc, slot(0));
+            _head = (_head + 1) & (_capacity - 1);
+            _size--;
+        }
+        void constructRange(Object* dest, const Object* values, size_t count) {
+            size_t built = 0;
+            try
+            {
+                for (; built < count; built++)
+                {
+                    AllocTraits::construct(alloc, dest + built, values[built]);
+                }
+            }
+            catch (...)
+            {
+                destroyRange(dest, built);
+                throw;
+            }
+        }
+        void destroyRange(Object* first, size_t count) {
+            for (size_t i = 0; i < count; i++)
+            {
+                AllocTraits::destroy(alloc, first + i);
+            }
+        }
+        void copyFrom(const Queue& other) {
+            reserve(other._size);
+            for (size_t i = 0; i < other._size; i++)
+            {
+                emplace(*other.slot(i));
+            }
+        }
+        // Moves the elements into a new buffer, unwrapped so the front lands at index 0.
+        void reallocate(size_t newCapacity) {
+            Object* newBuffer = allocate(newCapacity);
+            for (size_t i = 0; i < _size; i++)
+            {
+                Object* from = slot(i);
+                if constexpr (std::is_trivially_copyable_v<Object>)
+                {
+                    std::memcpy(static_cast<void*>(newBuffer + i), static_cast<const void*>(from), sizeof(Object));
+                }
+                else
+                {
+                    AllocTraits::construct(alloc, newBuffer + i, std::move_if_noexcept(*from));
+                    AllocTraits::destroy(alloc, from);
+                }
+            }
+            deallocate(buffer, _capacity);
+            buffer = newBuffer;
+            _capacity = newCapacity;
+            _head = 0;
+        }
 };
 
+template <typename Object>
+using PmrQueue = Queue<Object, std::pmr::polymorphic_allocator<Object>>;
+
 #endif  // QUEUE_H
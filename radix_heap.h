@@ -0,0 +1,128 @@
+#ifndef RADIX_HEAP_H
+#define RADIX_HEAP_H
+
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Payload type for a RadixHeap that only holds keys.
+struct RadixHeapNoValue {};
+
+// Monotone priority queue for unsigned keys, smallest key first: every key pushed must be
+// at least the current top (anything popped is gone for good, like timers or Dijkstra
+// distances). Bucket i holds the keys that first differ from the last minimum in bit
+// i - 1, so a key only ever moves to lower buckets and push is O(1), pop O(log C)
+// amortized for keys up to C. An optional Value is carried along with each key.
+template <class Key, class Value=RadixHeapNoValue>
+class RadixHeap {
+    static_assert(std::is_unsigned_v<Key>, "RadixHeap needs an unsigned key type");
+
+    private:
+        static constexpr size_t Buckets = std::numeric_limits<Key>::digits + 1;
+
+        struct Entry {
+            Key key;
+            Value value;
+        };
+        // top() moves keys down to bucket 0, which does not change the contents
+        mutable std::vector<Entry> buckets[Buckets];
+        mutable Key last; // current minimum, or the last one popped
+        size_t _size;
+
+    public:
+        RadixHeap() : last(0), _size(0) {}
+
+        bool empty() const {
+            return _size == 0;
+        }
+        size_t size() const {
+            return _size;
+        }
+        void clear() {
+            for (std::vector<Entry>& bucket : buckets)
+            {
+                bucket.clear();
+            }
+            last = 0;
+            _size = 0;
+        }
+
+        void push(Key key, const Value& value = Value()) {
+            checkMonotone(key);
+            buckets[bucketIndex(key)].push_back(Entry{key, value});
+            _size++;
+        }
+        void push(Key key, Value&& value) {
+            checkMonotone(key);
+            buckets[bucketIndex(key)].push_back(Entry{key, std::move(value)});
+            _size++;
+        }
+
+        const Key& top() const {
+            return front().key;
+        }
+        const Value& top_value() const {
+            return front().value;
+        }
+        void pop() {
+            front();
+            buckets[0].pop_back();
+            _size--;
+        }
+
+    private:
+        void checkMonotone(Key key) const {
+            if (key < last)
+            {
+                throw std::invalid_argument("RadixHeap keys must not go below the current minimum");
+            }
+        }
+
+        // 0 for the current minimum, otherwise one past the highest bit where key differs from it.
+        size_t bucketIndex(Key key) const {
+            Key diff = key ^ last;
+            size_t index = 0;
+            while (diff != 0)
+            {
+                diff >>= 1;
+                index++;
+            }
+            return index;
+        }
+
+        // Makes sure bucket 0 holds the minimum by splitting the lowest non-empty bucket.
+        const Entry& front() const {
+            if (_size == 0)
+            {
+                throw std::out_of_range("");
+            }
+            if (buckets[0].empty())
+            {
+                size_t i = 1;
+                while (buckets[i].empty())
+                {
+                    i++;
+                }
+                Key newLast = buckets[i][0].key;
+                for (const Entry& entry : buckets[i])
+                {
+                    if (entry.key < newLast)
+                    {
+                        newLast = entry.key;
+                    }
+                }
+                last = newLast;
+                for (Entry& entry : buckets[i])
+                {
+                    buckets[bucketIndex(entry.key)].push_back(std::move(entry));
+                }
+                buckets[i].clear();
+            }
+            return buckets[0].back();
+        }
+};
+
+#endif  // RADIX_HEAP_H
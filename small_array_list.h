@@ -0,0 +1,84 @@
+#ifndef SMALL_ARRAY_LIST_H
+#define SMALL_ARRAY_LIST_H
+
+#include "array_list.h"
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <type_traits>
+#include <utility>
+
+// Storage for the first N elements inside the list object itself.
+template <typename Object, size_t N>
+struct InlineBuffer {
+    static constexpr size_t capacity = N;
+
+    alignas(Object) unsigned char bytes[N * sizeof(Object)];
+
+    Object* data()
+    {
+        return reinterpret_cast<Object*>(bytes);
+    }
+    const Object* data() const
+    {
+        return reinterpret_cast<const Object*>(bytes);
+    }
+};
+
+// Same interface as ArrayList, but the first N elements live inside the object
+// itself. The heap is only touched once the list grows past N.
+template <typename Object, size_t N, class Allocator = std::allocator<Object>>
+class SmallArrayList : public ArrayListBase<Object, Allocator, InlineBuffer<Object, N>> {
+    static_assert(N > 0, "SmallArrayList needs room for at least one inline element");
+    using Base = ArrayListBase<Object, Allocator, InlineBuffer<Object, N>>;
+    using AllocTraits = std::allocator_traits<Allocator>;
+
+    public:
+        SmallArrayList() : Base(Allocator()) {}
+        explicit SmallArrayList(const Allocator& allocator) : Base(allocator) {}
+        explicit SmallArrayList(size_t s, const Allocator& allocator = Allocator()) : Base(allocator)
+        {
+            this->reserve(s);
+        }
+
+        SmallArrayList(const SmallArrayList& other) : Base(AllocTraits::select_on_container_copy_construction(other.alloc))
+        {
+            this->copyFrom(other);
+        }
+
+        // Inline elements can only be moved one by one.
+        SmallArrayList(SmallArrayList&& other) noexcept(std::is_nothrow_move_constructible_v<Object>) : Base(std::move(other.alloc))
+        {
+            this->takeFrom(other);
+        }
+
+        SmallArrayList& operator=(const SmallArrayList& other)
+        {
+            if (this != &other)
+            {
+                this->copyAssign(other);
+            }
+            return *this;
+        }
+
+        SmallArrayList& operator=(SmallArrayList&& other) noexcept(std::is_nothrow_move_constructible_v<Object>
+                                                                   && (AllocTraits::propagate_on_container_move_assignment::value
+                                                                       || AllocTraits::is_always_equal::value))
+        {
+            if (this != &other)
+            {
+                this->moveAssign(other);
+            }
+            return *this;
+        }
+
+        bool is_inline() const
+        {
+            return this->array == this->inlineData();
+        }
+};
+
+template <typename Object, size_t N>
+using PmrSmallArrayList = SmallArrayList<Object, N, std::pmr::polymorphic_allocator<Object>>;
+
+#endif  // SMALL_ARRAY_LIST_H
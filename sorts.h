@@ -151,17 +151,15 @@ void heap_sort(std::vector<Comparable>& container) {
     {
         return;
     }
-    heapify(&container);
-    vector<Comparable> sortedVector;
+    // max-heap in place, every pop moves the largest remaining element to the end of the heap
+    std::greater<Comparable> comp;
+    heap_make(container.begin(), container.end(), comp);
     cout << container << endl;
-    while(container.size() != 1)
+    for (size_t heapSize = container.size(); heapSize > 1; heapSize--)
     {
-        sortedVector.push_back(heap_get_min(container));
-        heap_delete_min(&container);
+        heap_pop(container.begin(), container.begin() + heapSize, comp);
         cout << container << endl;
-        cout << sortedVector << endl;
     }
-    std::swap(container,sortedVector);
 }
 
 template <class Comparable>
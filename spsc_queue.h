@@ -0,0 +1,206 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <thread>
+#include <utility>
+
+// Bounded lock-free queue for exactly one producer thread and one consumer thread.
+// The head and tail live on their own cache lines, and each side keeps a cached copy
+// of the other side's index so it only touches the shared line when it looks full/empty.
+template <typename Object, class Allocator = std::allocator<Object>>
+class SpscQueue {
+    private:
+        using AllocTraits = std::allocator_traits<Allocator>;
+        static constexpr size_t CacheLine = 64;
+
+        // Set at construction, read-only afterwards
+        Allocator alloc;
+        Object* buffer;
+        size_t _capacity;
+        size_t mask;
+
+        // Consumer side
+        alignas(CacheLine) std::atomic<size_t> _head;
+        size_t cachedTail;
+
+        // Producer side
+        alignas(CacheLine) std::atomic<size_t> _tail;
+        size_t cachedHead;
+
+    public:
+        using allocator_type = Allocator;
+
+        // Capacity is rounded up to a power of two.
+        explicit SpscQueue(size_t capacity, const Allocator& allocator = Allocator())
+            : alloc(allocator), buffer(nullptr), _capacity(roundUpPowerOfTwo(capacity)), mask(_capacity - 1),
+              _head(0), cachedTail(0), _tail(0), cachedHead(0)
+        {
+            buffer = AllocTraits::allocate(alloc, _capacity);
+        }
+        SpscQueue(const SpscQueue& other) = delete;
+        SpscQueue& operator=(const SpscQueue& other) = delete;
+        ~SpscQueue() {
+            size_t head = _head.load(std::memory_order_relaxed);
+            size_t tail = _tail.load(std::memory_order_relaxed);
+            for (; head != tail; head++)
+            {
+                AllocTraits::destroy(alloc, buffer + (head & mask));
+            }
+            AllocTraits::deallocate(alloc, buffer, _capacity);
+        }
+
+        // Producer only.
+        template <class... Args>
+        bool try_emplace(Args&&... args) {
+            size_t tail = _tail.load(std::memory_order_relaxed);
+            if (tail - cachedHead == _capacity)
+            {
+                cachedHead = _head.load(std::memory_order_acquire);
+                if (tail - cachedHead == _capacity)
+                {
+                    return false;
+                }
+            }
+            AllocTraits::construct(alloc, buffer + (tail & mask), std::forward<Args>(args)...);
+            _tail.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+        bool try_enqueue(const Object& other) {
+            return try_emplace(other);
+        }
+        bool try_enqueue(Object&& other) {
+            return try_emplace(std::move(other));
+        }
+        // Spins until there is room.
+        void enqueue(const Object& other) {
+            while (!try_emplace(other))
+            {
+                std::this_thread::yield();
+            }
+        }
+        void enqueue(Object&& other) {
+            while (!try_emplace(std::move(other)))
+            {
+                std::this_thread::yield();
+            }
+        }
+        // Writes as many of the values as fit and publishes them with a single store.
+        // Returns how many were written.
+        size_t enqueue_n(const Object* values, size_t count) {
+            size_t tail = _tail.load(std::memory_order_relaxed);
+            if (_capacity - (tail - cachedHead) < count)
+            {
+                cachedHead = _head.load(std::memory_order_acquire);
+            }
+            size_t room = _capacity - (tail - cachedHead);
+            size_t written = count < room ? count : room;
+            for (size_t i = 0; i < written; i++)
+            {
+                AllocTraits::construct(alloc, buffer + ((tail + i) & mask), values[i]);
+            }
+            if (written != 0)
+            {
+                _tail.store(tail + written, std::memory_order_release);
+            }
+            return written;
+        }
+
+        // Consumer only.
+        bool try_dequeue(Object& out) {
+            size_t head = _head.load(std::memory_order_relaxed);
+            if (head == cachedTail)
+            {
+                cachedTail = _tail.load(std::memory_order_acquire);
+                if (head == cachedTail)
+                {
+                    return false;
+                }
+            }
+            Object* slot = buffer + (head & mask);
+            out = std::move(*slot);
+            AllocTraits::destroy(alloc, slot);
+            _head.store(head + 1, std::memory_order_release);
+            return true;
+        }
+        // Spins until an element shows up.
+        Object dequeue() {
+            size_t head = _head.load(std::memory_order_relaxed);
+            while (head == cachedTail)
+            {
+                cachedTail = _tail.load(std::memory_order_acquire);
+                if (head == cachedTail)
+                {
+                    std::this_thread::yield();
+                }
+            }
+            Object* slot = buffer + (head & mask);
+            Object first = std::move(*slot);
+            AllocTraits::destroy(alloc, slot);
+            _head.store(head + 1, std::memory_order_release);
+            return first;
+        }
+        // Moves out up to count elements and frees their slots with a single store.
+        size_t dequeue_n(Object* out, size_t count) {
+            size_t head = _head.load(std::memory_order_relaxed);
+            if (cachedTail - head < count)
+            {
+                cachedTail = _tail.load(std::memory_order_acquire);
+            }
+            size_t available = cachedTail - head;
+            size_t taken = count < available ? count : available;
+            for (size_t i = 0; i < taken; i++)
+            {
+                Object* slot = buffer + ((head + i) & mask);
+                out[i] = std::move(*slot);
+                AllocTraits::destroy(alloc, slot);
+            }
+            if (taken != 0)
+            {
+                _head.store(head + taken, std::memory_order_release);
+            }
+            return taken;
+        }
+        // Consumer only, the element stays in the queue.
+        Object* front() {
+            size_t head = _head.load(std::memory_order_relaxed);
+            if (head == cachedTail)
+            {
+                cachedTail = _tail.load(std::memory_order_acquire);
+                if (head == cachedTail)
+                {
+                    return nullptr;
+                }
+            }
+            return buffer + (head & mask);
+        }
+
+        // Either side; only a snapshot while the other side is running.
+        size_t size() const {
+            // head first: it can only catch up to a tail read afterwards, never pass it
+            size_t head = _head.load(std::memory_order_acquire);
+            size_t tail = _tail.load(std::memory_order_acquire);
+            return tail - head;
+        }
+        bool empty() const {
+            return size() == 0;
+        }
+        size_t capacity() const {
+            return _capacity;
+        }
+
+    private:
+        static size_t roundUpPowerOfTwo(size_t n) {
+            size_t capacity = 1;
+            while (capacity < n)
+            {
+                capacity *= 2;
+            }
+            return capacity;
+        }
+};
+
+#endif  // SPSC_QUEUE_H
@@ -1,19 +1,25 @@
 #ifndef STACK_H
 #define STACK_H
 
-#include "doubly_linked_list.h"
+#include "array_list.h"
 #include <cstddef>
 #include <iostream>
+#include <memory>
+#include <memory_resource>
 #include <stdexcept> 
 #include <utility>
 
-template <typename Object>
+// Stack on top of a contiguous ArrayList, the top is the last element
+// so push and pop never shift anything and only allocate when the array grows.
+template <typename Object, class Allocator = std::allocator<Object>>
 class Stack {
    private:
-      DoublyLinkedList<Object> list;
+      ArrayList<Object, Allocator> list;
    public:
-      Stack<Object>() : list({}) {}
+      Stack() : list() {}
+      explicit Stack(const Allocator& alloc) : list(alloc) {}
       Stack(const Stack& other) : list(other.list) {}
+      Stack(Stack&& other) noexcept : list(std::move(other.list)) {}
       ~Stack() {
          list.clear();
       }
@@ -22,26 +28,73 @@ class Stack {
          {
             return *this;
          }
-         list.clear();
          list = other.list;
          return *this;
       }
+      Stack& operator=(Stack&& other) noexcept(noexcept(list = std::move(other.list))) {
+         list = std::move(other.list);
+         return *this;
+      }
+      size_t size() const {
+         return list.size();
+      }
+      bool empty() const {
+         return list.empty();
+      }
+      void reserve(size_t capacity) {
+         list.reserve(capacity);
+      }
       void push(const Object& other) {
-         list.insert(0, other);
+         list.emplace_back(other);
+      }
+      void push(Object&& other) {
+         list.emplace_back(std::move(other));
+      }
+      template <class... Args>
+      Object& emplace(Args&&... args) {
+         return list.emplace_back(std::forward<Args>(args)...);
       }
-      void pop() {
-         list.remove(0);
+      // Pushes values[0] first, so values[count - 1] ends up on top.
+      void push_n(const Object* values, size_t count) {
+         list.append(values, count);
+      }
+      Object pop() {
+         if (list.empty())
+         {
+            throw std::out_of_range("");
+         }
+         size_t last = list.size() - 1;
+         Object value = std::move(list[last]);
+         list.remove(last);
+         return value;
       }
       Object& top() {
-         return list[0];
+         if (list.empty())
+         {
+            throw std::out_of_range("");
+         }
+         return list[list.size() - 1];
+      }
+      const Object& top() const {
+         if (list.empty())
+         {
+            throw std::out_of_range("");
+         }
+         return list[list.size() - 1];
       }
       void printStack() {
          if (list.size() == 0)
          {
             std::cout << "Stack empty" << std::endl;
          }
-         list.printList();
+         for (size_t i = list.size(); i > 0; i--)
+         {
+            std::cout << "[ " << list[i - 1] << " ]" << std::endl;
+         }
       }
 };
 
+template <typename Object>
+using PmrStack = Stack<Object, std::pmr::polymorphic_allocator<Object>>;
+
 #endif  // STACK_H
\ No newline at end of file
@@ -0,0 +1,119 @@
+#include "../array_list.h"
+#include "../small_array_list.h"
+#include <cassert>
+#include <stdexcept>
+
+// Counts live objects and throws from the copy constructor once copiesLeft runs out.
+// Its move may throw too, so growing the list has to copy it.
+struct Fragile {
+    static int live;
+    static int copiesLeft;
+
+    int value;
+    bool alive;
+
+    Fragile(int v) : value(v), alive(true) {
+        live++;
+    }
+    Fragile(const Fragile& other) : value(other.value), alive(true) {
+        assert(other.alive);
+        if (copiesLeft-- == 0)
+        {
+            throw std::runtime_error("copy");
+        }
+        live++;
+    }
+    Fragile(Fragile&& other) : Fragile(static_cast<const Fragile&>(other)) {}
+    ~Fragile() {
+        assert(alive); // destroyed twice otherwise
+        alive = false;
+        live--;
+    }
+};
+int Fragile::live = 0;
+int Fragile::copiesLeft = 1 << 30;
+
+template <class List>
+static void fill(List& list, int count) {
+    for (int i = 0; i < count; i++)
+    {
+        list.emplace_back(i);
+    }
+}
+
+template <class List>
+static void assertIntact(const List& list, int count) {
+    assert(list.size() == (size_t) count);
+    for (int i = 0; i < count; i++)
+    {
+        assert(list[i].alive && list[i].value == i);
+    }
+}
+
+template <class Operation>
+static bool throwsAfter(int copies, Operation operation) {
+    Fragile::copiesLeft = copies;
+    bool threw = false;
+    try
+    {
+        operation();
+    }
+    catch (const std::runtime_error&)
+    {
+        threw = true;
+    }
+    Fragile::copiesLeft = 1 << 30;
+    return threw;
+}
+
+// A copy failing halfway through growth leaves the list as it was.
+static void growthKeepsElements() {
+    {
+        ArrayList<Fragile> list;
+        fill(list, 4);
+        size_t capacity = list.capacity();
+        assert(capacity == 4);
+        assert(throwsAfter(2, [&] { list.push_back(Fragile(99)); }));
+        assertIntact(list, 4);
+        assert(list.capacity() == capacity && Fragile::live == 4);
+        list.emplace_back(4);
+        assertIntact(list, 5);
+        assert(throwsAfter(3, [&] { list.reserve(64); }));
+        assertIntact(list, 5);
+        assert(list.capacity() == 8 && Fragile::live == 5);
+
+        for (int i = 5; i < 8; i++)
+        {
+            list.emplace_back(i);
+        }
+        assert(throwsAfter(4, [&] { list.insert(2, Fragile(99)); }));
+        assertIntact(list, 8);
+        assert(list.capacity() == 8 && Fragile::live == 8);
+    }
+    assert(Fragile::live == 0);
+}
+
+// Spilling out of the inline buffer and moving a list that is still inline.
+static void inlineBufferKeepsElements() {
+    {
+        SmallArrayList<Fragile, 4> list;
+        fill(list, 4);
+        assert(throwsAfter(2, [&] { list.emplace_back(4); }));
+        assert(list.is_inline());
+        assertIntact(list, 4);
+
+        SmallArrayList<Fragile, 4> other;
+        fill(other, 3);
+        assert(throwsAfter(1, [&] { list = std::move(other); }));
+        assert(other.is_inline());
+        assertIntact(other, 3);
+        assert(Fragile::live == 3);
+    }
+    assert(Fragile::live == 0);
+}
+
+int main() {
+    growthKeepsElements();
+    inlineBufferKeepsElements();
+    return 0;
+}
@@ -0,0 +1,136 @@
+#include "../doubly_linked_list.h"
+#include <cassert>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Tagged allocator that follows its source on copy and move assignment.
+template <class T>
+struct TaggedAllocator {
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+
+    int tag;
+
+    explicit TaggedAllocator(int t = 0) : tag(t) {}
+    template <class U>
+    TaggedAllocator(const TaggedAllocator<U>& other) : tag(other.tag) {}
+
+    T* allocate(size_t n) {
+        return std::allocator<T>().allocate(n);
+    }
+    void deallocate(T* p, size_t n) {
+        std::allocator<T>().deallocate(p, n);
+    }
+};
+template <class T, class U>
+bool operator==(const TaggedAllocator<T>& a, const TaggedAllocator<U>& b) {
+    return a.tag == b.tag;
+}
+template <class T, class U>
+bool operator!=(const TaggedAllocator<T>& a, const TaggedAllocator<U>& b) {
+    return a.tag != b.tag;
+}
+
+template <class List>
+static std::vector<int> contents(const List& list) {
+    std::vector<int> out;
+    for (auto it = list.begin(); it != list.end(); ++it)
+    {
+        out.push_back(*it);
+    }
+    return out;
+}
+
+// Moving the last node of another list to the end of this one is a real move.
+static void spliceTailAcrossLists() {
+    DoublyLinkedList<int> a;
+    DoublyLinkedList<int> b;
+    a.push_back(1);
+    a.push_back(2);
+    b.push_back(10);
+    b.push_back(20);
+    a.splice(a.end(), b, std::prev(b.end()));
+    assert((contents(a) == std::vector<int>{1, 2, 20}));
+    assert((contents(b) == std::vector<int>{10}));
+    assert(a.size() == 3 && b.size() == 1);
+    assert(a.back() == 20 && b.back() == 10);
+
+    // also into an empty list, and out of a single element list
+    DoublyLinkedList<int> c;
+    c.splice(c.end(), b, b.begin());
+    assert((contents(c) == std::vector<int>{10}));
+    assert(b.empty() && b.begin() == b.end());
+    assert(c.front() == 10 && c.back() == 10);
+}
+
+// Within one list a node already in front of pos stays where it is.
+static void spliceInPlace() {
+    DoublyLinkedList<int> a;
+    for (int i = 1; i <= 3; i++)
+    {
+        a.push_back(i);
+    }
+    a.splice(a.end(), a, std::prev(a.end()));
+    a.splice(a.begin(), a, a.begin());
+    a.splice(std::next(a.begin()), a, a.begin());
+    assert((contents(a) == std::vector<int>{1, 2, 3}));
+    a.splice(a.begin(), a, std::prev(a.end()));
+    assert((contents(a) == std::vector<int>{3, 1, 2}));
+    assert(a.size() == 3);
+}
+
+// Moves hand the nodes over; only unequal, non propagating allocators move element by element.
+static void moveSemantics() {
+    DoublyLinkedList<std::string> a;
+    a.push_back("one");
+    a.push_back("two");
+    const std::string* first = &a.front();
+    DoublyLinkedList<std::string> b(std::move(a));
+    assert(a.empty() && a.begin() == a.end());
+    assert(b.size() == 2 && &b.front() == first);
+    a.push_back("three");
+    a = std::move(b);
+    assert(b.empty() && a.size() == 2 && &a.front() == first);
+
+    std::pmr::monotonic_buffer_resource left;
+    std::pmr::monotonic_buffer_resource right;
+    PmrDoublyLinkedList<std::string> p(&left);
+    p.push_back("x");
+    p.push_back("y");
+    PmrDoublyLinkedList<std::string> q(&right);
+    q = std::move(p);
+    assert(q.get_allocator().resource() == &right);
+    assert((q.front() == "x" && q.back() == "y" && q.size() == 2 && p.empty()));
+    PmrDoublyLinkedList<std::string> r(std::move(q), &right);
+    const std::string* kept = &r.front();
+    PmrDoublyLinkedList<std::string> s(std::move(r), &right);
+    assert(q.empty() && r.empty() && &s.front() == kept);
+}
+
+static void allocatorPropagation() {
+    using List = DoublyLinkedList<int, TaggedAllocator<int>>;
+    List a{TaggedAllocator<int>(1)};
+    List b{TaggedAllocator<int>(2)};
+    a.push_back(1);
+    b.push_back(2);
+    b.push_back(3);
+    a = b;
+    assert(a.get_allocator().tag == 2);
+    assert((contents(a) == std::vector<int>{2, 3}));
+    List c{TaggedAllocator<int>(3)};
+    c = std::move(a);
+    assert(c.get_allocator().tag == 2 && c.size() == 2 && a.empty());
+}
+
+int main() {
+    spliceTailAcrossLists();
+    spliceInPlace();
+    moveSemantics();
+    allocatorPropagation();
+    return 0;
+}
@@ -0,0 +1,282 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include "node_pool.h"
+#include "queue.h"
+#include "work_stealing_deque.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Fork-join thread pool. Every worker owns a work-stealing deque: tasks spawned from a
+// worker go to the bottom of its own deque and idle workers steal from the top of
+// the others, so there is no central queue in the hot path. Tasks submitted from
+// outside the pool go through a small locked inject queue.
+//
+//     ThreadPool pool;
+//     ThreadPool::TaskGroup group(pool);
+//     group.run([&] { sort(left); });
+//     group.run([&] { sort(right); });
+//     group.wait(); // runs pending tasks itself instead of blocking
+class ThreadPool {
+    private:
+        struct Task;
+
+    public:
+        // A set of tasks that can be waited on together. Tasks may run more groups.
+        class TaskGroup {
+            private:
+                ThreadPool& pool;
+                std::atomic<size_t> pending;
+                std::mutex errorLock;
+                std::exception_ptr error;
+                friend class ThreadPool;
+
+            public:
+                explicit TaskGroup(ThreadPool& p) : pool(p), pending(0) {}
+                TaskGroup(const TaskGroup& other) = delete;
+                TaskGroup& operator=(const TaskGroup& other) = delete;
+                ~TaskGroup() {
+                    pool.helpUntilDone(*this);
+                }
+
+                template <class F>
+                void run(F&& f) {
+                    pending.fetch_add(1, std::memory_order_relaxed);
+                    pool.spawn(createTask(std::forward<F>(f), this));
+                }
+                // Helps with any pending work until every task of the group has finished,
+                // then rethrows the first exception one of them threw.
+                void wait() {
+                    pool.helpUntilDone(*this);
+                    std::exception_ptr e;
+                    {
+                        std::lock_guard<std::mutex> guard(errorLock);
+                        e = error;
+                        error = nullptr;
+                    }
+                    if (e)
+                    {
+                        std::rethrow_exception(e);
+                    }
+                }
+        };
+
+        explicit ThreadPool(size_t threads = std::thread::hardware_concurrency())
+            : stopping(false), sleepers(0)
+        {
+            if (threads == 0)
+            {
+                threads = 1;
+            }
+            for (size_t i = 0; i < threads; i++)
+            {
+                deques.push_back(std::make_unique<WorkStealingDeque<Task*>>());
+            }
+            for (size_t i = 0; i < threads; i++)
+            {
+                workers.emplace_back([this, i] { workerLoop(i); });
+            }
+        }
+        ThreadPool(const ThreadPool& other) = delete;
+        ThreadPool& operator=(const ThreadPool& other) = delete;
+        // Every task group has to be finished by now.
+        ~ThreadPool() {
+            {
+                std::lock_guard<std::mutex> guard(sleepLock);
+                stopping.store(true, std::memory_order_relaxed);
+            }
+            wakeUp.notify_all();
+            for (std::thread& t : workers)
+            {
+                t.join();
+            }
+        }
+
+        size_t size() const {
+            return workers.size();
+        }
+
+    private:
+        struct Task {
+            std::function<void()> fn;
+            TaskGroup* group;
+        };
+        using TaskAllocator = PoolAllocator<Task>;
+        using TaskTraits = std::allocator_traits<TaskAllocator>;
+
+        // Which pool and deque the current thread works for, if any.
+        struct WorkerSlot {
+            ThreadPool* pool;
+            size_t index;
+        };
+        static inline thread_local WorkerSlot current{nullptr, 0};
+
+        std::vector<std::unique_ptr<WorkStealingDeque<Task*>>> deques;
+        std::vector<std::thread> workers;
+        std::mutex injectLock;
+        Queue<Task*> injected;
+        std::atomic<bool> stopping;
+
+        // Idle workers sleep here, the lock is only taken when someone is asleep.
+        std::mutex sleepLock;
+        std::condition_variable wakeUp;
+        std::atomic<size_t> sleepers;
+
+        template <class F>
+        static Task* createTask(F&& f, TaskGroup* group) {
+            TaskAllocator alloc;
+            Task* task = TaskTraits::allocate(alloc, 1);
+            try
+            {
+                TaskTraits::construct(alloc, task, Task{std::function<void()>(std::forward<F>(f)), group});
+            }
+            catch (...)
+            {
+                TaskTraits::deallocate(alloc, task, 1);
+                group->pending.fetch_sub(1, std::memory_order_relaxed);
+                throw;
+            }
+            return task;
+        }
+        static void destroyTask(Task* task) {
+            TaskAllocator alloc;
+            TaskTraits::destroy(alloc, task);
+            TaskTraits::deallocate(alloc, task, 1);
+        }
+
+        void spawn(Task* task) {
+            if (current.pool == this)
+            {
+                deques[current.index]->push(task);
+            }
+            else
+            {
+                std::lock_guard<std::mutex> guard(injectLock);
+                injected.enqueue(task);
+            }
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (sleepers.load(std::memory_order_relaxed) != 0)
+            {
+                std::lock_guard<std::mutex> guard(sleepLock);
+                wakeUp.notify_one();
+            }
+        }
+
+        void execute(Task* task) {
+            TaskGroup* group = task->group;
+            try
+            {
+                task->fn();
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> guard(group->errorLock);
+                if (!group->error)
+                {
+                    group->error = std::current_exception();
+                }
+            }
+            destroyTask(task);
+            group->pending.fetch_sub(1, std::memory_order_release);
+        }
+
+        // Own deque first (newest task, still warm in cache), then the inject queue,
+        // then the oldest task of some other worker.
+        Task* findTask() {
+            Task* task = nullptr;
+            size_t self = current.pool == this ? current.index : deques.size();
+            if (self < deques.size() && deques[self]->pop(task))
+            {
+                return task;
+            }
+            {
+                std::lock_guard<std::mutex> guard(injectLock);
+                if (injected.try_dequeue(task))
+                {
+                    return task;
+                }
+            }
+            size_t n = deques.size();
+            size_t start = nextVictim() % n;
+            for (size_t i = 0; i < n; i++)
+            {
+                size_t victim = (start + i) % n;
+                if (victim != self && deques[victim]->steal(task))
+                {
+                    return task;
+                }
+            }
+            return nullptr;
+        }
+
+        bool workVisible() {
+            for (const std::unique_ptr<WorkStealingDeque<Task*>>& d : deques)
+            {
+                if (!d->empty())
+                {
+                    return true;
+                }
+            }
+            std::lock_guard<std::mutex> guard(injectLock);
+            return !injected.empty();
+        }
+
+        static size_t nextVictim() {
+            thread_local size_t state = std::hash<std::thread::id>()(std::this_thread::get_id()) | 1;
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            return state;
+        }
+
+        void workerLoop(size_t index) {
+            current = WorkerSlot{this, index};
+            for (;;)
+            {
+                if (Task* task = findTask())
+                {
+                    execute(task);
+                    continue;
+                }
+                std::unique_lock<std::mutex> guard(sleepLock);
+                sleepers.fetch_add(1, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                // anything spawned before we registered is visible now, anything after will notify
+                while (!stopping.load(std::memory_order_relaxed) && !workVisible())
+                {
+                    wakeUp.wait(guard);
+                }
+                sleepers.fetch_sub(1, std::memory_order_relaxed);
+                if (stopping.load(std::memory_order_relaxed))
+                {
+                    return;
+                }
+            }
+        }
+
+        // Runs tasks from anywhere in the pool until the group is done, so a task waiting
+        // on its children never ties up its thread.
+        void helpUntilDone(TaskGroup& group) {
+            while (group.pending.load(std::memory_order_acquire) != 0)
+            {
+                if (Task* task = findTask())
+                {
+                    execute(task);
+                }
+                else
+                {
+                    std::this_thread::yield();
+                }
+            }
+        }
+};
+
+#endif  // THREAD_POOL_H
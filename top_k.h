@@ -0,0 +1,165 @@
+#ifndef TOP_K_H
+#define TOP_K_H
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "heap.h"
+
+// Keeps the K largest values (under Compare) seen in a stream in O(K) memory.
+// The kept values form a heap with the smallest one on top, which is the threshold a
+// new value has to beat; once K values are in, most offers are rejected by one compare.
+// Per thread selectors can be combined with merge.
+template <class Comparable, class Compare=std::less<Comparable>>
+class TopK {
+    private:
+        static constexpr size_t BatchChunk = 64;
+
+        Compare compare;
+        size_t k;
+        std::vector<Comparable> heap; // smallest kept value at index 0
+
+    public:
+        explicit TopK(size_t count, const Compare& comp = Compare()) : compare(comp), k(count), heap()
+        {
+            heap.reserve(k);
+        }
+
+        size_t size() const {
+            return heap.size();
+        }
+        size_t capacity() const {
+            return k;
+        }
+        bool empty() const {
+            return heap.empty();
+        }
+        bool full() const {
+            return heap.size() == k;
+        }
+        void clear() {
+            heap.clear();
+        }
+        // Smallest value still kept, the bar a new value has to clear once full.
+        const Comparable& threshold() const {
+            if (heap.empty())
+            {
+                throw std::out_of_range("");
+            }
+            return heap.front();
+        }
+
+        // Returns true when the value was kept.
+        bool offer(const Comparable& value) {
+            if (k == 0)
+            {
+                return false;
+            }
+            if (full())
+            {
+                if (!accepts(value))
+                {
+                    return false;
+                }
+                replaceThreshold(value);
+                return true;
+            }
+            heap.push_back(value);
+            heap_push(heap.begin(), heap.end(), compare);
+            return true;
+        }
+        bool offer(Comparable&& value) {
+            if (k == 0)
+            {
+                return false;
+            }
+            if (full())
+            {
+                if (!accepts(value))
+                {
+                    return false;
+                }
+                replaceThreshold(std::move(value));
+                return true;
+            }
+            heap.push_back(std::move(value));
+            heap_push(heap.begin(), heap.end(), compare);
+            return true;
+        }
+        // Batch version. Once full, every chunk is first screened against the threshold in
+        // a branch free loop the compiler can vectorize, and only the survivors touch the heap.
+        void offer(const Comparable* values, size_t count) {
+            if (k == 0)
+            {
+                return;
+            }
+            size_t i = 0;
+            for (; i < count && !full(); i++)
+            {
+                offer(values[i]);
+            }
+            bool survives[BatchChunk];
+            while (i < count)
+            {
+                size_t chunk = count - i < BatchChunk ? count - i : BatchChunk;
+                const Comparable& bar = heap.front();
+                bool any = false;
+                for (size_t j = 0; j < chunk; j++)
+                {
+                    survives[j] = compare(bar, values[i + j]);
+                    any |= survives[j];
+                }
+                if (any)
+                {
+                    for (size_t j = 0; j < chunk; j++)
+                    {
+                        // the bar only goes up inside the chunk, check again
+                        if (survives[j] && accepts(values[i + j]))
+                        {
+                            replaceThreshold(values[i + j]);
+                        }
+                    }
+                }
+                i += chunk;
+            }
+        }
+
+        // Folds in the values kept by other, which may have a different K.
+        void merge(const TopK& other) {
+            offer(other.heap.data(), other.heap.size());
+        }
+        void merge(TopK&& other) {
+            if (other.heap.size() > heap.size() && other.k == k)
+            {
+                std::swap(heap, other.heap);
+            }
+            for (Comparable& value : other.heap)
+            {
+                offer(std::move(value));
+            }
+            other.heap.clear();
+        }
+
+        // The kept values, largest first.
+        std::vector<Comparable> sorted() const {
+            std::vector<Comparable> result(heap);
+            std::sort(result.begin(), result.end(), [this](const Comparable& a, const Comparable& b) {
+                return compare(b, a);
+            });
+            return result;
+        }
+
+    private:
+        bool accepts(const Comparable& value) const {
+            return compare(heap.front(), value);
+        }
+        template <class T>
+        void replaceThreshold(T&& value) {
+            heap_place_down(heap.begin(), heap.size(), 0, std::forward<T>(value), compare);
+        }
+};
+
+#endif  // TOP_K_H
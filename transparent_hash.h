@@ -0,0 +1,30 @@
+#ifndef TRANSPARENT_HASH_H
+#define TRANSPARENT_HASH_H
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// Lookups with a type other than the key (string_view against std::string keys, say)
+// are only enabled when both the hash and the equality are marked is_transparent,
+// which promises they agree on equal values of either type.
+template <class Hash, class KeyEqual, class = void>
+struct IsTransparentLookup : std::false_type {};
+
+template <class Hash, class KeyEqual>
+struct IsTransparentLookup<Hash, KeyEqual, std::void_t<typename Hash::is_transparent, typename KeyEqual::is_transparent>>
+    : std::true_type {};
+
+// Hashes std::string, string_view and C strings alike without building a temporary
+// std::string. Pair it with std::equal_to<> as the key equality.
+struct TransparentStringHash {
+    using is_transparent = void;
+
+    size_t operator()(std::string_view s) const noexcept {
+        return std::hash<std::string_view>{}(s);
+    }
+};
+
+#endif  // TRANSPARENT_HASH_H
@@ -2,8 +2,10 @@
 #define AVL_TREE_H
 
 #include <iostream>
+#include <memory>
+#include <memory_resource>
 
-template <typename Comparable>
+template <typename Comparable, class Allocator = std::allocator<Comparable>>
 class AVLTree {
     private:
         struct TreeNode {
@@ -12,10 +14,17 @@ class AVLTree {
             TreeNode* left;
             TreeNode* right;
         };
+        using NodeAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<TreeNode>;
+        using NodeTraits = std::allocator_traits<NodeAllocator>;
+
+        NodeAllocator nodeAlloc;
         TreeNode* root;
     public:
-        AVLTree <Comparable>() : root(nullptr) {}
-        AVLTree(const AVLTree& other) : root(nullptr) {
+        using allocator_type = Allocator;
+
+        AVLTree() : nodeAlloc(), root(nullptr) {}
+        explicit AVLTree(const Allocator& alloc) : nodeAlloc(alloc), root(nullptr) {}
+        AVLTree(const AVLTree& other) : nodeAlloc(NodeTraits::select_on_container_copy_construction(other.nodeAlloc)), root(nullptr) {
             root = copyHelper2(other.root);
         }
         AVLTree& operator=(const AVLTree& other) {
@@ -32,7 +41,7 @@ class AVLTree {
             {
                 return nullptr;
             }
-            TreeNode* newNode = new TreeNode;
+            TreeNode* newNode = createNode();
             newNode->data = node->data;
             newNode->height = node->height;
             newNode->left = copyHelper2(node->left); // newNode is defined, cool. But its left and right aren't. Thus we define them here
@@ -48,8 +57,31 @@ class AVLTree {
             {
                 destroyTree(node->left); // delete its left node and all its subtrees
                 destroyTree(node->right); // delete its right node and all its subtrees
-                delete node; // delete the node itself
+                destroyNode(node); // delete the node itself
+            }
+        }
+
+        TreeNode* createNode() {
+            TreeNode* node = NodeTraits::allocate(nodeAlloc, 1);
+            try
+            {
+                NodeTraits::construct(nodeAlloc, node);
+            }
+            catch (...)
+            {
+                NodeTraits::deallocate(nodeAlloc, node, 1);
+                throw;
             }
+            return node;
+        }
+
+        void destroyNode(TreeNode* node) {
+            NodeTraits::destroy(nodeAlloc, node);
+            NodeTraits::deallocate(nodeAlloc, node, 1);
+        }
+
+        Allocator get_allocator() const {
+            return Allocator(nodeAlloc);
         }
         bool contains(const Comparable& value) const {
             return containsHelper(value, root);
@@ -81,7 +113,7 @@ class AVLTree {
             {
                 if (root == nullptr) // empty tree
                 {
-                    TreeNode* newNode = new TreeNode;
+                    TreeNode* newNode = createNode();
                     newNode->left = nullptr;
                     newNode->right = nullptr;
                     newNode->data = value;
@@ -91,7 +123,7 @@ class AVLTree {
                 }
                 if (node == nullptr)
                 {
-                    TreeNode* newNode = new TreeNode;
+                    TreeNode* newNode = createNode();
                     newNode->left = nullptr;
                     newNode->right = nullptr;
                     newNode->data = value;
@@ -182,7 +214,7 @@ class AVLTree {
                         {
                             root = toReturn;
                         }
-                        delete node;
+                        destroyNode(node);
                         node = toReturn;
                     }
                     else if (node->right == nullptr && node->left != nullptr) // one child (left)
@@ -192,7 +224,7 @@ class AVLTree {
                         {
                             root = toReturn;
                         }
-                        delete node;
+                        destroyNode(node);
                         node = toReturn;
                     }
                     else if (node->left == nullptr && node->right == nullptr) // no children
@@ -201,7 +233,7 @@ class AVLTree {
                         {
                             root = nullptr;
                         }
-                        delete node;
+                        destroyNode(node);
                         return nullptr;
                     }
                     else // two children 
@@ -391,4 +423,7 @@ class AVLTree {
         
 };
 
+template <typename Comparable>
+using PmrAVLTree = AVLTree<Comparable, std::pmr::polymorphic_allocator<Comparable>>;
+
 #endif
\ No newline at end of file
@@ -2,12 +2,14 @@
 #define BINARY_SEARCH_TREE_H
 
 #include <iostream>
+#include <memory>
+#include <memory_resource>
 #include <queue>
 #include <stack>
 
 using std::queue, std::stack;
 
-template <typename Comparable>
+template <typename Comparable, class Allocator = std::allocator<Comparable>>
 class BinarySearchTree {
     private: 
         struct TreeNode {
@@ -15,11 +17,18 @@ class BinarySearchTree {
             TreeNode* left;
             TreeNode* right;
         };
+        using NodeAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<TreeNode>;
+        using NodeTraits = std::allocator_traits<NodeAllocator>;
+
+        NodeAllocator nodeAlloc;
         TreeNode* root;
     public:
-        BinarySearchTree <Comparable>() : root(nullptr) {}
+        using allocator_type = Allocator;
 
-        BinarySearchTree(const BinarySearchTree& other) : root(nullptr) {
+        BinarySearchTree() : nodeAlloc(), root(nullptr) {}
+        explicit BinarySearchTree(const Allocator& alloc) : nodeAlloc(alloc), root(nullptr) {}
+
+        BinarySearchTree(const BinarySearchTree& other) : nodeAlloc(NodeTraits::select_on_container_copy_construction(other.nodeAlloc)), root(nullptr) {
             root = copyHelper2(other.root);
         }
 
@@ -37,7 +46,7 @@ class BinarySearchTree {
             {
                 return nullptr;
             }
-            TreeNode* newNode = new TreeNode;
+            TreeNode* newNode = createNode();
             newNode->data = node->data;
             newNode->left = copyHelper2(node->left); // newNode is defined, cool. But its left and right aren't. Thus we define them here
             newNode->right = copyHelper2(node->right);
@@ -54,8 +63,31 @@ class BinarySearchTree {
             {
                 destroyTree(node->left); // delete its left node and all its subtrees
                 destroyTree(node->right); // delete its right node and all its subtrees
-                delete node; // delete the node itself
+                destroyNode(node); // delete the node itself
+            }
+        }
+
+        TreeNode* createNode() {
+            TreeNode* node = NodeTraits::allocate(nodeAlloc, 1);
+            try
+            {
+                NodeTraits::construct(nodeAlloc, node);
+            }
+            catch (...)
+            {
+                NodeTraits::deallocate(nodeAlloc, node, 1);
+                throw;
             }
+            return node;
+        }
+
+        void destroyNode(TreeNode* node) {
+            NodeTraits::destroy(nodeAlloc, node);
+            NodeTraits::deallocate(nodeAlloc, node, 1);
+        }
+
+        Allocator get_allocator() const {
+            return Allocator(nodeAlloc);
         }
 
         bool contains(const Comparable& value) const {
@@ -90,7 +122,7 @@ class BinarySearchTree {
             {
                 if (root == nullptr) // empty tree
                 {
-                    TreeNode* newNode = new TreeNode;
+                    TreeNode* newNode = createNode();
                     newNode->left = nullptr;
                     newNode->right = nullptr;
                     newNode->data = value;
@@ -99,7 +131,7 @@ class BinarySearchTree {
                 }
                 if (node == nullptr)
                 {
-                    TreeNode* newNode = new TreeNode;
+                    TreeNode* newNode = createNode();
                     newNode->left = nullptr;
                     newNode->right = nullptr;
                     newNode->data = value;
@@ -151,7 +183,7 @@ class BinarySearchTree {
                         {
                             root = toReturn;
                         }
-                        delete node;
+                        destroyNode(node);
                         return toReturn;
                     }
                     else if (node->right == nullptr && node->left != nullptr) // one child (left)
@@ -161,7 +193,7 @@ class BinarySearchTree {
                         {
                             root = toReturn;
                         }
-                        delete node;
+                        destroyNode(node);
                         return toReturn;
                     }
                     else if (node->left == nullptr && node->right == nullptr) // no children
@@ -170,7 +202,7 @@ class BinarySearchTree {
                         {
                             root = nullptr;
                         }
-                        delete node;
+                        destroyNode(node);
                         return nullptr;
                     }
                     else // two children 
@@ -341,4 +373,7 @@ class BinarySearchTree {
         }
 };
 
+template <typename Comparable>
+using PmrBinarySearchTree = BinarySearchTree<Comparable, std::pmr::polymorphic_allocator<Comparable>>;
+
 #endif
\ No newline at end of file
@@ -2,8 +2,10 @@
 #define RED_BLACK_TREE_H
 
 #include <iostream>
+#include <memory>
+#include <memory_resource>
 
-template <typename Comparable>
+template <typename Comparable, class Allocator = std::allocator<Comparable>>
 class RedBlackTree {
     private: 
         struct Node {
@@ -13,13 +15,20 @@ class RedBlackTree {
             Node* parent;
             int color;
         };
+        using NodeAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Node>;
+        using NodeTraits = std::allocator_traits<NodeAllocator>;
+
+        NodeAllocator nodeAlloc;
         Node* root;
     public:
         enum Color {RED, BLACK};
         
-        RedBlackTree <Comparable>() : root(nullptr) {}
+        using allocator_type = Allocator;
 
-        RedBlackTree(const RedBlackTree& other) : root(nullptr) {
+        RedBlackTree() : nodeAlloc(), root(nullptr) {}
+        explicit RedBlackTree(const Allocator& alloc) : nodeAlloc(alloc), root(nullptr) {}
+
+        RedBlackTree(const RedBlackTree& other) : nodeAlloc(NodeTraits::select_on_container_copy_construction(other.nodeAlloc)), root(nullptr) {
             root = copyHelper(other.root);
             if (root)
             {
@@ -46,7 +55,7 @@ class RedBlackTree {
             {
                 return nullptr;
             }
-            Node* newNode = new Node;
+            Node* newNode = createNode();
             newNode->value = node->value;
             newNode->color = node->color;
             newNode->left = copyHelper(node->left); // newNode is defined, cool. But its left and right aren't. Thus we define them here
@@ -76,13 +85,36 @@ class RedBlackTree {
             {
                 destroyTree(node->left); // delete its left node and all its subtrees
                 destroyTree(node->right); // delete its right node and all its subtrees
-                delete node; // delete the node itself
+                destroyNode(node); // delete the node itself
+            }
+        }
+
+        Node* createNode() {
+            Node* node = NodeTraits::allocate(nodeAlloc, 1);
+            try
+            {
+                NodeTraits::construct(nodeAlloc, node);
+            }
+            catch (...)
+            {
+                NodeTraits::deallocate(nodeAlloc, node, 1);
+                throw;
             }
+            return node;
+        }
+
+        void destroyNode(Node* node) {
+            NodeTraits::destroy(nodeAlloc, node);
+            NodeTraits::deallocate(nodeAlloc, node, 1);
+        }
+
+        Allocator get_allocator() const {
+            return Allocator(nodeAlloc);
         }
 
         void insert(const Comparable& data) {
             if (!contains(data)) {
-                Node* toInsert = new Node;
+                Node* toInsert = createNode();
                 toInsert->left = nullptr;
                 toInsert->right = nullptr;
                 toInsert->parent = nullptr;
@@ -191,7 +223,7 @@ class RedBlackTree {
             }
             if (toFind == root && !root->right && !root->left)
             {
-                delete root;
+                destroyNode(root);
                 root = nullptr;
                 return;
             }
@@ -223,7 +255,7 @@ class RedBlackTree {
                 {
                     toFind->parent->left = nullptr;
                 }
-                delete toFind;
+                destroyNode(toFind);
                 toFind = nullptr;
                 marker = toFind;
             }
@@ -339,13 +371,13 @@ class RedBlackTree {
                 if (marker->right && !marker->left)
                 {
                     marker->value = marker->right->value;
-                    delete marker->right;
+                    destroyNode(marker->right);
                     marker->right = nullptr;
                 }
                 else if (marker->left && !marker->right)
                 {
                     marker->value = marker->left->value;
-                    delete marker->left;
+                    destroyNode(marker->left);
                     marker->left = nullptr;
                 }
                 else if (!marker->left && !marker->right)
@@ -354,7 +386,7 @@ class RedBlackTree {
                         marker->parent->right = nullptr;
                     else if (marker->parent->left == marker)
                         marker->parent->left = nullptr;
-                    delete marker;
+                    destroyNode(marker);
                 }
             }
             if (replaceValueRoot)
@@ -589,5 +621,8 @@ class RedBlackTree {
 
 };
 
+template <typename Comparable>
+using PmrRedBlackTree = RedBlackTree<Comparable, std::pmr::polymorphic_allocator<Comparable>>;
+
 #endif  // RED_BLACK_TREE_H
 
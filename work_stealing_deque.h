@@ -0,0 +1,153 @@
+#ifndef WORK_STEALING_DEQUE_H
+#define WORK_STEALING_DEQUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+// Chase-Lev work-stealing deque. One owner thread pushes and pops at the bottom like
+// a stack without any atomic read-modify-write; any number of thieves take from the
+// top with a single CAS. Only the last element is fought over by owner and thieves.
+// The buffer grows when full; old buffers stay alive until the deque is destroyed
+// because a thief may still be reading from one.
+// Thieves copy elements before they know they won the race, so Object has to be
+// trivially copyable (in practice a pointer to a task).
+template <typename Object>
+class WorkStealingDeque {
+    private:
+        static_assert(std::is_trivially_copyable_v<Object>, "WorkStealingDeque needs a trivially copyable type");
+
+        static constexpr size_t CacheLine = 64;
+
+        struct Array {
+            size_t capacity;
+            size_t mask;
+            std::atomic<Object>* slots;
+
+            explicit Array(size_t c) : capacity(c), mask(c - 1), slots(new std::atomic<Object>[c]) {}
+            ~Array() {
+                delete[] slots;
+            }
+            Object get(int64_t i) const {
+                return slots[i & mask].load(std::memory_order_relaxed);
+            }
+            void put(int64_t i, Object x) {
+                slots[i & mask].store(x, std::memory_order_relaxed);
+            }
+        };
+
+        alignas(CacheLine) std::atomic<int64_t> _top;
+        alignas(CacheLine) std::atomic<int64_t> _bottom;
+        std::atomic<Array*> array;
+        std::vector<Array*> retired; // owner only
+
+    public:
+        // Capacity is rounded up to a power of two.
+        explicit WorkStealingDeque(size_t capacity = 64) : _top(0), _bottom(0), array(nullptr)
+        {
+            size_t c = 2;
+            while (c < capacity)
+            {
+                c *= 2;
+            }
+            array.store(new Array(c), std::memory_order_relaxed);
+        }
+        WorkStealingDeque(const WorkStealingDeque& other) = delete;
+        WorkStealingDeque& operator=(const WorkStealingDeque& other) = delete;
+        ~WorkStealingDeque() {
+            delete array.load(std::memory_order_relaxed);
+            for (Array* a : retired)
+            {
+                delete a;
+            }
+        }
+
+        // Owner only.
+        void push(Object x) {
+            int64_t b = _bottom.load(std::memory_order_relaxed);
+            int64_t t = _top.load(std::memory_order_acquire);
+            Array* a = array.load(std::memory_order_relaxed);
+            if (b - t > (int64_t) a->capacity - 1)
+            {
+                a = grow(a, t, b);
+            }
+            a->put(b, x);
+            _bottom.store(b + 1, std::memory_order_release);
+        }
+        // Owner only, takes the most recently pushed element.
+        bool pop(Object& out) {
+            int64_t b = _bottom.load(std::memory_order_relaxed) - 1;
+            Array* a = array.load(std::memory_order_relaxed);
+            _bottom.store(b, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t t = _top.load(std::memory_order_relaxed);
+            if (t > b)
+            {
+                // already empty
+                _bottom.store(b + 1, std::memory_order_relaxed);
+                return false;
+            }
+            Object x = a->get(b);
+            if (t == b)
+            {
+                // last element, race the thieves for it
+                bool won = _top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+                _bottom.store(b + 1, std::memory_order_relaxed);
+                if (!won)
+                {
+                    return false;
+                }
+            }
+            out = x;
+            return true;
+        }
+
+        // Any thread, takes the oldest element. Also returns false when it lost a race
+        // with another thief or the owner, so false does not mean the deque is empty.
+        bool steal(Object& out) {
+            int64_t t = _top.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t b = _bottom.load(std::memory_order_acquire);
+            if (t >= b)
+            {
+                return false;
+            }
+            Array* a = array.load(std::memory_order_acquire);
+            Object x = a->get(t);
+            if (!_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            {
+                return false;
+            }
+            out = x;
+            return true;
+        }
+
+        // Only a snapshot while other threads are running.
+        size_t size() const {
+            int64_t b = _bottom.load(std::memory_order_relaxed);
+            int64_t t = _top.load(std::memory_order_relaxed);
+            return b > t ? (size_t) (b - t) : 0;
+        }
+        bool empty() const {
+            return size() == 0;
+        }
+        size_t capacity() const {
+            return array.load(std::memory_order_relaxed)->capacity;
+        }
+
+    private:
+        Array* grow(Array* old, int64_t t, int64_t b) {
+            Array* bigger = new Array(old->capacity * 2);
+            for (int64_t i = t; i < b; i++)
+            {
+                bigger->put(i, old->get(i));
+            }
+            retired.push_back(old);
+            array.store(bigger, std::memory_order_release);
+            return bigger;
+        }
+};
+
+#endif  // WORK_STEALING_DEQUE_H